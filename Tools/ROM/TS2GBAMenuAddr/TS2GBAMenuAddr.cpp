@@ -31,10 +31,10 @@
 	------------------------------------
 	File: TS2GBAMenuAddr.cpp | TS2GBAMenuAddr.hpp
 	Authors: SuperSaiyajinStackZ
-	Version: 0.1.0
+	Version: 0.3.0
 	Purpose: Get a Menu's function pointer addresses of The Sims 2 GBA.
 	Category: ROM Tools
-	Last Updated: 17 December 2021
+	Last Updated: 18 October 2026
 	------------------------------------
 
 	To compile this, run:
@@ -44,9 +44,15 @@
 
 
 #include "TS2GBAMenuAddr.hpp" // Header of this file.
+#include <algorithm> // std::sort and std::equal_range for the reference index and the symbol map.
+#include <numeric> // std::iota for the order of the addresses in TS2GBAMenuAddr::LookupSymbols.
 #include <cstring> // memcmp to compare the ROM's TID.
 #include <unistd.h> // access() to check for ROM File existence.
 
+#ifdef __SSE2__
+	#include <emmintrin.h> // SSE2 to check 4 pointers at once in TS2GBAMenuAddr::BuildReferenceIndex.
+#endif
+
 
 
 /*
@@ -106,6 +112,210 @@ uint32_t TS2GBAMenuAddr::GetMenuAddress(const uint32_t MenuID, const bool OnPrep
 };
 
 
+/*
+	Builds the reference index, by going once through the whole ROM and collecting every 4 byte aligned value
+	which points into the ROM (0x08000000 - 0x09FFFFFF), sorted by what it points to.
+	Afterwards GetReferences can tell who references an address in logarithmic time.
+*/
+void TS2GBAMenuAddr::BuildReferenceIndex() {
+	this->References.clear();
+	if (!this->GetValid() || !this->ROMData || !this->ROMData.get()) return;
+
+	const uint8_t *Data = this->ROMData.get();
+	uint32_t Offs = 0x0;
+
+	#ifdef __SSE2__
+		/* SSE2 only compares signed, so flip the sign bit: (Value - 0x08000000) < 0x02000000 unsigned is the same as this signed. */
+		const __m128i Base = _mm_set1_epi32(0x08000000), Sign = _mm_set1_epi32((int)0x80000000), Limit = _mm_set1_epi32((int)(0x02000000 ^ 0x80000000));
+
+		for (; Offs + 0x10 <= this->ROMSize; Offs += 0x10) {
+			const __m128i Values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Data + Offs));
+			const __m128i InRange = _mm_cmplt_epi32(_mm_xor_si128(_mm_sub_epi32(Values, Base), Sign), Limit);
+
+			int Mask = _mm_movemask_ps(_mm_castsi128_ps(InRange));
+			while (Mask) {
+				const uint8_t Lane = __builtin_ctz(Mask);
+				Mask &= Mask - 1;
+
+				uint32_t Value = 0x0;
+				memcpy(&Value, Data + Offs + (Lane * 0x4), 0x4);
+				this->References.push_back({ Value, Offs + (Lane * 0x4) });
+			}
+		}
+	#endif
+
+	for (; Offs + 0x4 <= this->ROMSize; Offs += 0x4) {
+		uint32_t Value = 0x0;
+		memcpy(&Value, Data + Offs, 0x4);
+		if (Value - 0x08000000 < 0x02000000) this->References.push_back({ Value, Offs });
+	}
+
+	/* The sweep already collected them sorted by Source, so a stable sort by Target keeps the Sources in order. */
+	std::stable_sort(this->References.begin(), this->References.end(), [](const Reference &A, const Reference &B) { return A.Target < B.Target; });
+	this->References.shrink_to_fit();
+};
+
+
+/*
+	Get all ROM offsets which contain a pointer to Target. BuildReferenceIndex needs to be called first.
+
+	const uint32_t Target: The GBA address to get the references of, such as 0x08064F85. Note that Thumb function pointers have bit 0 set.
+*/
+std::vector<uint32_t> TS2GBAMenuAddr::GetReferences(const uint32_t Target) const {
+	std::vector<uint32_t> Sources;
+
+	const auto Range = std::equal_range(this->References.begin(), this->References.end(), Reference{ Target, 0x0 },
+		[](const Reference &A, const Reference &B) { return A.Target < B.Target; });
+
+	for (auto It = Range.first; It != Range.second; It++) Sources.push_back(It->Source);
+	return Sources;
+};
+
+
+/*
+	Builds the symbol map out of the prepare and logic functions of all menus and the symbols of LoadSymbols.
+
+	Loaded symbols replace the menu ones at the same address, menus which share a function get their names joined with a '/'.
+	A symbol without a size reaches up to the next one, and no symbol reaches into the next one, so each address belongs to at most one symbol.
+*/
+void TS2GBAMenuAddr::BuildSymbolMap() {
+	this->Symbols.clear();
+	if (!this->GetValid()) return;
+
+	/* The second is true for loaded symbols. */
+	std::vector<std::pair<Symbol, bool>> All;
+
+	for (uint32_t MenuID = 0x0; MenuID < this->GetMenuAmount(); MenuID++) {
+		for (const bool OnPrepare : { true, false }) {
+			const uint32_t Offs = this->GetMenuAddress(MenuID, OnPrepare);
+			if (Offs == 0x0) continue;
+
+			char Name[0x20] = { '\0' };
+			snprintf(Name, sizeof(Name), "Menu_%02X_%s", MenuID, (OnPrepare ? "Prepare" : "Logic"));
+			All.push_back({ { Offs + 0x08000000, Offs + 0x08000000, Name }, false });
+		}
+	}
+
+	for (const Symbol &Loaded : this->LoadedSymbols) All.push_back({ Loaded, true });
+
+	/* Stable, so the loaded symbols stay after the menu ones of the same address. */
+	std::stable_sort(All.begin(), All.end(), [](const auto &A, const auto &B) { return A.first.Address < B.first.Address; });
+
+	for (size_t Idx = 0; Idx < All.size(); Idx++) {
+		if (!this->Symbols.empty() && this->Symbols.back().Address == All[Idx].first.Address) {
+			if (All[Idx].second) this->Symbols.back() = All[Idx].first;
+			else this->Symbols.back().Name += "/" + All[Idx].first.Name;
+			continue;
+		}
+
+		this->Symbols.push_back(All[Idx].first);
+	}
+
+	/*
+		A symbol ends at the next one at the latest. Without a size, it also ends after UnsizedLength bytes and never reaches
+		into another memory region (such as from IWRAM into the ROM), so addresses far behind it are not reported as part of it.
+	*/
+	for (size_t Idx = 0; Idx < this->Symbols.size(); Idx++) {
+		Symbol &Sym = this->Symbols[Idx];
+		const uint32_t RegionEnd = (Sym.Address >= 0x08000000 ? 0x08000000 + this->ROMSize : (Sym.Address & 0xFF000000) + 0x01000000);
+		const uint32_t Next = (Idx + 1 < this->Symbols.size() ? this->Symbols[Idx + 1].Address : RegionEnd);
+
+		Sym.End = (Sym.Sized ? std::min(Sym.End, Next) : std::min({ RegionEnd, Next, Sym.Address + this->UnsizedLength }));
+	}
+};
+
+
+/*
+	Loads a symbol file and rebuilds the symbol map with it.
+
+	Each line is "ADDR NAME [SIZE]" in hexadecimal, where ADDR may also be a ROM offset (any value below the ROM size), like the .sym files of no$gba or the ones of ExportSymbols.
+	Empty lines, comments starting with '#' or ';' and directives such as ".thumb" get skipped.
+
+	const std::string &SymPath: The path to the symbol file.
+
+	Returns false if the file could not be opened.
+*/
+bool TS2GBAMenuAddr::LoadSymbols(const std::string &SymPath) {
+	FILE *In = fopen(SymPath.c_str(), "r");
+	if (!In) return false;
+
+	char Line[0x200] = { '\0' };
+	while (fgets(Line, sizeof(Line), In)) {
+		char Name[0x100] = { '\0' };
+		uint32_t Address = 0x0, Size = 0x0;
+
+		if (Line[0] == '#' || Line[0] == ';') continue;
+		if (sscanf(Line, "%x %255s %x", &Address, Name, &Size) < 2 || Name[0] == '.') continue;
+
+		Address = ToAddress(Address) & ~0x1; // Thumb function pointers have bit 0 set.
+		this->LoadedSymbols.push_back({ Address, Address + Size, Name, Size != 0x0 });
+	}
+
+	fclose(In);
+	this->BuildSymbolMap();
+	return true;
+};
+
+
+/*
+	Get the symbol an address belongs to. BuildSymbolMap or LoadSymbols needs to be called first.
+
+	const uint32_t Address: The GBA address, such as the PC of a crash log.
+
+	Returns nullptr if it doesn't belong to any symbol.
+*/
+const TS2GBAMenuAddr::Symbol *TS2GBAMenuAddr::LookupSymbol(const uint32_t Address) const {
+	auto It = std::upper_bound(this->Symbols.begin(), this->Symbols.end(), Address, [](const uint32_t Addr, const Symbol &Sym) { return Addr < Sym.Address; });
+	if (It == this->Symbols.begin()) return nullptr;
+
+	It--;
+	return (Address < It->End ? &(*It) : nullptr);
+};
+
+
+/*
+	Looks up many addresses at once. They get sorted first and then matched in a single sweep over the symbols,
+	instead of a binary search for each of them.
+
+	const uint32_t *Addresses: The GBA addresses to look up.
+	const size_t Amount: The amount of addresses.
+	const Symbol **Results: Where the symbol of each address gets stored, nullptr if it doesn't belong to any.
+*/
+void TS2GBAMenuAddr::LookupSymbols(const uint32_t *Addresses, const size_t Amount, const Symbol **Results) const {
+	std::vector<uint32_t> Order(Amount);
+	std::iota(Order.begin(), Order.end(), 0);
+	std::sort(Order.begin(), Order.end(), [Addresses](const uint32_t A, const uint32_t B) { return Addresses[A] < Addresses[B]; });
+
+	size_t Sym = 0;
+	for (const uint32_t Idx : Order) {
+		const uint32_t Address = Addresses[Idx];
+		while (Sym < this->Symbols.size() && this->Symbols[Sym].End <= Address) Sym++;
+
+		Results[Idx] = (Sym < this->Symbols.size() && this->Symbols[Sym].Address <= Address ? &this->Symbols[Sym] : nullptr);
+	}
+};
+
+
+/*
+	Exports the symbol map in the .sym format of no$gba, "ADDR NAME" per line sorted by the address.
+	Symbols with a known size get it as "ADDR NAME SIZE", so loading the file again gives the same symbol map.
+
+	const std::string &SymPath: The path to write to.
+
+	Returns false if the file could not be written.
+*/
+bool TS2GBAMenuAddr::ExportSymbols(const std::string &SymPath) const {
+	FILE *Out = fopen(SymPath.c_str(), "w");
+	if (!Out) return false;
+
+	for (const Symbol &Sym : this->Symbols) {
+		if (Sym.Sized) fprintf(Out, "%08X %s %X\n", Sym.Address, Sym.Name.c_str(), Sym.End - Sym.Address);
+		else fprintf(Out, "%08X %s\n", Sym.Address, Sym.Name.c_str());
+	}
+	return fclose(Out) == 0;
+};
+
+
 /* Direct Use would include this int main. */
 #ifdef _DIRECT_USE
 
@@ -117,9 +327,11 @@ uint32_t TS2GBAMenuAddr::GetMenuAddress(const uint32_t MenuID, const bool OnPrep
 	int main(int Argc, char *Argv[]) {
 		if (Argc > 1) {
 			bool Provided[2] = { false, false };
+			bool RefsProvided = false;
 
-			std::string ROMPath = "";
-			uint32_t MenuID = 0x0;
+			std::string ROMPath = "", LookupArg = "", ExportPath = "";
+			std::vector<std::string> SymPaths;
+			uint32_t MenuID = 0x0, RefAddr = 0x0;
 
 			/* Go through all Arguments. */
 			for (size_t Idx = 1; Idx < (size_t)Argc; Idx++) {
@@ -127,7 +339,7 @@ uint32_t TS2GBAMenuAddr::GetMenuAddress(const uint32_t MenuID, const bool OnPrep
 
 				/* -i => Input. */
 				if (ARG == "-i" || ARG == "-input") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-i'.");
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-i'.");
 					ROMPath = Argv[Idx + 1];
 
 					Provided[0] = true;
@@ -136,7 +348,7 @@ uint32_t TS2GBAMenuAddr::GetMenuAddress(const uint32_t MenuID, const bool OnPrep
 
 				/* -id => Menu ID in hexadecimal. */
 				} else if (ARG == "-id") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-id'.");
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-id'.");
 					
 					MenuID = strtoul(Argv[Idx + 1], nullptr, 16);
 
@@ -144,19 +356,109 @@ uint32_t TS2GBAMenuAddr::GetMenuAddress(const uint32_t MenuID, const bool OnPrep
 					Idx++;
 					continue;
 
+				/* -refs => Address to get the references of, in hexadecimal. */
+				} else if (ARG == "-refs") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-refs'.");
+
+					RefAddr = strtoul(Argv[Idx + 1], nullptr, 16);
+					RefAddr = TS2GBAMenuAddr::ToAddress(RefAddr);
+
+					RefsProvided = true;
+					Idx++;
+					continue;
+
+				/* -sym => Symbol file to add to the symbol map, may be provided multiple times. */
+				} else if (ARG == "-sym") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-sym'.");
+
+					SymPaths.push_back(Argv[Idx + 1]);
+					Idx++;
+					continue;
+
+				/* -lookup => Address or a file with one address per line to get the symbols of. */
+				} else if (ARG == "-lookup") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-lookup'.");
+
+					LookupArg = Argv[Idx + 1];
+					Idx++;
+					continue;
+
+				/* -export => Path to write the symbol map to. */
+				} else if (ARG == "-export") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-export'.");
+
+					ExportPath = Argv[Idx + 1];
+					Idx++;
+					continue;
+
 				} else {
 					return AbortMain("Not a valid parameter provided.");
 				}
 			}
 
 			/* Ensure all needed parameters have been provided to work on. */
-			for (int8_t Idx = 0; Idx < 2; Idx++) {
+			const bool SymbolMode = !LookupArg.empty() || !ExportPath.empty();
+			for (int8_t Idx = 0; Idx < (RefsProvided || SymbolMode ? 1 : 2); Idx++) {
 				if (!Provided[Idx]) return AbortMain("Not all needed parameters have been provided.");
 			}
 
 			/* The actual action. */
 			std::unique_ptr<TS2GBAMenuAddr> Getter = std::make_unique<TS2GBAMenuAddr>(ROMPath);
 			if (Getter && Getter->GetValid()) {
+				if (SymbolMode) {
+					Getter->BuildSymbolMap();
+					for (const std::string &SymPath : SymPaths) {
+						if (!Getter->LoadSymbols(SymPath)) return AbortMain("The symbol file " + SymPath + " could not be opened.");
+					}
+
+					if (!ExportPath.empty()) {
+						if (!Getter->ExportSymbols(ExportPath)) return AbortMain("The symbol map could not be exported.");
+						printf("%zu symbols have been exported to %s.\n", Getter->GetSymbols().size(), ExportPath.c_str());
+					}
+
+					if (!LookupArg.empty()) {
+						/* Either a file with one address per line, such as the PCs of a crash log, or a single address. */
+						std::vector<uint32_t> Addresses;
+						if (FILE *In = fopen(LookupArg.c_str(), "r")) {
+							char Line[0x40] = { '\0' };
+							while (fgets(Line, sizeof(Line), In)) {
+								char *End = nullptr;
+								const uint32_t Address = strtoul(Line, &End, 16);
+								if (End != Line) Addresses.push_back(Address);
+							}
+
+							fclose(In);
+						} else {
+							Addresses.push_back(strtoul(LookupArg.c_str(), nullptr, 16));
+						}
+
+						for (uint32_t &Address : Addresses) Address = TS2GBAMenuAddr::ToAddress(Address);
+
+						std::vector<const TS2GBAMenuAddr::Symbol *> Results(Addresses.size());
+						Getter->LookupSymbols(Addresses.data(), Addresses.size(), Results.data());
+
+						for (size_t Idx = 0; Idx < Addresses.size(); Idx++) {
+							if (Results[Idx]) printf("%08X: %s+0x%X\n", Addresses[Idx], Results[Idx]->Name.c_str(), Addresses[Idx] - Results[Idx]->Address);
+							else printf("%08X: ??\n", Addresses[Idx]);
+						}
+					}
+				}
+
+				if (RefsProvided) {
+					Getter->BuildReferenceIndex();
+
+					/* Thumb function pointers have bit 0 set, so check both the address and the address + 1. */
+					for (const uint32_t Target : { RefAddr, RefAddr | 0x1 }) {
+						const std::vector<uint32_t> Sources = Getter->GetReferences(Target);
+						printf("%zu references to %08X found.\n", Sources.size(), Target);
+
+						for (const uint32_t Source : Sources) printf("  at %08X or when running: %08X.\n", Source, Source + 0x08000000);
+						if (Target == (RefAddr | 0x1)) break;
+					}
+				}
+
+				if ((RefsProvided || SymbolMode) && !Provided[1]) return 0;
+
 				if (MenuID >= Getter->GetMenuAmount()) return AbortMain("The Menu ID is too high");
 
 				uint32_t MenuAddr = Getter->GetMenuAddress(MenuID, true);
@@ -176,11 +478,17 @@ uint32_t TS2GBAMenuAddr::GetMenuAddress(const uint32_t MenuID, const bool OnPrep
 		/* No arguments provided => Show info. */
 		} else {
 			printf(
-				"TS2GBAMenuAddr v0.1.0 by SuperSaiyajinStackZ, © 2021-2022.\n" \
+				"TS2GBAMenuAddr v0.3.0 by SuperSaiyajinStackZ, © 2021-2022.\n" \
 				"Purpose: Get a Menu's function pointer addresses of The Sims 2 GBA.\n\n" \
-				"Usage: -i <PathToROM> -id <Hexadecimal ID of the Menu>\n\n" \
+				"Usage: -i <PathToROM> -id <Hexadecimal ID of the Menu>\n" \
+				"Refs:  -i <PathToROM> -refs <Hexadecimal Address or ROM offset>\n" \
+				"Syms:  -i <PathToROM> [-sym <PathToSymbols>] [-lookup <Hexadecimal Address or PathToAddresses>] [-export <PathToOutput>]\n\n" \
 				"Use -i or -input and then the path to the ROM to provide it as the ROM Source.\n" \
-				"Use -id to provide the ID of the menu in hexadecimal format you want to get the addresses from.\n"
+				"Use -id to provide the ID of the menu in hexadecimal format you want to get the addresses from.\n" \
+				"Use -refs to list everything in the ROM that points to the provided address.\n" \
+				"Use -sym to add the symbols of a \"ADDR NAME [SIZE]\" file to the ones of the menu table, multiple times if needed.\n" \
+				"Use -lookup to get the symbols of an address or of all addresses in a file, one per line.\n" \
+				"Use -export to write the symbol map to a no$gba .sym file.\n"
 			);
 		}
 
@@ -29,12 +29,44 @@
 
 #include <memory> // std::unique_ptr because i like those instead of raw pointers.
 #include <string> // Default include, it's always in my projects.
+#include <vector> // std::vector for the reference index and the symbol map.
 
 
 class TS2GBAMenuAddr {
 public:
+	/* A 4 byte aligned pointer inside the ROM. Source is the ROM offset of the pointer, Target the GBA address it points to. */
+	struct Reference {
+		uint32_t Target = 0x0;
+		uint32_t Source = 0x0;
+	};
+
+	/*
+		A named range of the memory, such as a menu function. Address is the GBA address of the start (without the Thumb bit),
+		End the address right after it.
+	*/
+	struct Symbol {
+		uint32_t Address = 0x0;
+		uint32_t End = 0x0;
+		std::string Name = "";
+		bool Sized = false; // If the size is known, otherwise it reaches up to the next symbol, but at most UnsizedLength bytes.
+	};
+
+	static constexpr uint32_t UnsizedLength = 0x1000; // Menu handlers are Thumb functions of a few hundred bytes, so 4 KB leaves plenty of room.
+
 	TS2GBAMenuAddr(const std::string &ROMPath);
 	uint32_t GetMenuAddress(const uint32_t MenuID, const bool OnPrepare) const;
+	void BuildReferenceIndex();
+	std::vector<uint32_t> GetReferences(const uint32_t Target) const;
+
+	void BuildSymbolMap();
+	bool LoadSymbols(const std::string &SymPath);
+	const Symbol *LookupSymbol(const uint32_t Address) const;
+	void LookupSymbols(const uint32_t *Addresses, const size_t Amount, const Symbol **Results) const;
+	bool ExportSymbols(const std::string &SymPath) const;
+	const std::vector<Symbol> &GetSymbols() const { return this->Symbols; };
+
+	/* Turns a ROM offset (below the ROM size) into its GBA address, everything else already is one, such as BIOS, EWRAM or IWRAM addresses. */
+	static uint32_t ToAddress(const uint32_t Value) { return (Value < ROMSize ? Value + 0x08000000 : Value); };
 
 	bool GetValid() const { return this->ROMValid; };
 	uint32_t GetMenuAmount() const { return 0x28; };
@@ -43,6 +75,9 @@ private:
 	static constexpr uint8_t TID[4] = { 0x42, 0x34, 0x36, 0x45 };
 	static constexpr uint32_t ROMSize = 0x2000000;
 	bool ROMValid = false;
+	std::vector<Reference> References; // Sorted by Target, then Source.
+	std::vector<Symbol> Symbols; // Sorted by Address, not overlapping.
+	std::vector<Symbol> LoadedSymbols; // From LoadSymbols.
 };
 
 #endif
\ No newline at end of file
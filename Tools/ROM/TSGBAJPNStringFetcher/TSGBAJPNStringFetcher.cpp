@@ -31,23 +31,41 @@
 	------------------------------------
 	File: TSGBAJPNStringFetcher.cpp | TSGBAJPNStringFetcher.hpp
 	Authors: SuperSaiyajinStackZ
-	Version: 0.2.0
+	Version: 0.3.0
 	Purpose: "Extract" in-game strings as raw bytes from The Sims Game Boy Advance Japanese games.
 	Category: ROM Tools
-	Last Updated: 05 December 2021
+	Last Updated: 18 October 2026
 	------------------------------------
 
 	To compile this, run:
 	g++ -D_DIRECT_USE -std=c++20 TSGBAJPNStringFetcher.cpp -o TSGBAJPNStringFetcher.exe
 	^ If you want to use your own int main, then don't include -D_DIRECT_USE.
+	^ Add -D_STATS to fill the stats of the fetcher, which can be printed with the -stats parameter.
 */
 
 
 #include "TSGBAJPNStringFetcher.hpp" // Header of this file.
+#include <bit> // std::bit_width for the histogram buckets of TSGBAJPNStringFetcher::Stats.
+#include <charconv> // std::to_chars for the String IDs of TSGBAJPNStringWriter.
+#include <chrono> // std::chrono::steady_clock for the timers of TSGBAJPNStringFetcher::Stats.
 #include <cstring> // memcmp to compare the ROM's TID.
 #include <unistd.h> // access() to check for ROM File existence.
 
 
+#ifdef _STATS
+	/* Returns the nanoseconds which passed since Start. */
+	static uint64_t ElapsedNS(const std::chrono::steady_clock::time_point &Start) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+	};
+
+	/* Adds a call which took NS nanoseconds to the histogram. */
+	static void AddToHistogram(TSGBAJPNStringFetcher::Stats::Histogram &Hist, const uint64_t NS) {
+		const uint8_t Bucket = std::min<uint8_t>(std::bit_width(NS), TSGBAJPNStringFetcher::Stats::HistogramBuckets - 1);
+		Hist[Bucket].fetch_add(1, std::memory_order_relaxed);
+	};
+#endif
+
+
 
 /*
 	Constructor for TSGBAJPNStringFetcher, which checks the passed ROM for validation and loads it into RAM.
@@ -55,6 +73,7 @@
 	const std::string &ROMPath: The path to the ROM to load.
 */
 TSGBAJPNStringFetcher::TSGBAJPNStringFetcher(const std::string &ROMPath) {
+	TSGBAJPN_STAT(auto Start = std::chrono::steady_clock::now();)
 	if (access(ROMPath.c_str(), F_OK) != 0) return;
 
 	FILE *In = fopen(ROMPath.c_str(), "rb");
@@ -63,6 +82,7 @@ TSGBAJPNStringFetcher::TSGBAJPNStringFetcher(const std::string &ROMPath) {
 		fseek(In, 0, SEEK_END);
 		const uint32_t Size = ftell(In);
 		fseek(In, 0, SEEK_SET);
+		TSGBAJPN_STAT(this->Statistics.OpenTime = ElapsedNS(Start); Start = std::chrono::steady_clock::now();)
 
 		if (Size >= this->MinROMSize && Size <= this->MaxROMSize) {
 			/* Check for the Magic Byte at 0xB2 that it's 0x96. */
@@ -85,9 +105,13 @@ TSGBAJPNStringFetcher::TSGBAJPNStringFetcher(const std::string &ROMPath) {
 					}
 				}
 
+				TSGBAJPN_STAT(this->Statistics.ValidateTime = ElapsedNS(Start); Start = std::chrono::steady_clock::now();)
+
 				if (this->SupportedGame()) {
-					this->ROMData = std::make_unique<uint8_t[]>(Size);
-					fread(this->ROMData.get(), 0x1, Size, In);
+					std::unique_ptr<uint8_t[]> Data = std::make_unique<uint8_t[]>(Size);
+					fread(Data.get(), 0x1, Size, In);
+					this->ROMData = std::move(Data);
+					TSGBAJPN_STAT(this->Statistics.ReadTime = ElapsedNS(Start);)
 				}
 			}
 		}
@@ -105,32 +129,34 @@ TSGBAJPNStringFetcher::TSGBAJPNStringFetcher(const std::string &ROMPath) {
 
 	Returns a std::vector<uint8_t> with the wanted string.
 */
-std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
+std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) const {
 	std::vector<uint8_t> ResVec          = { };
 	uint8_t              Counter         = 0x0;
 	uint16_t             Character       = 0x0;
 	uint32_t             ShiftVal        = 0x0;
 	uint32_t             ShiftAddr       = 0x0;
 	TSGBAJPNStringFetcher::StringLocs     Locs;
+	TSGBAJPN_STAT(const auto Start = std::chrono::steady_clock::now(); uint64_t Bits = 0x0;)
 
 	/* Ensure the data are valid and the ID is in proper range before we do it. */
 	if (this->SupportedGame() && this->ROMData && this->ROMData.get() && StringID <= this->GetMaxStringID()) {
 		Locs = this->GetLocForGame();
 
-		ShiftAddr = (Locs.Address1 + *reinterpret_cast<uint32_t *>(this->ROMData.get() + (StringID * 0x4) + Locs.Address2));
-		ShiftVal = *reinterpret_cast<uint32_t *>(this->ROMData.get() + ShiftAddr);
+		ShiftAddr = (Locs.Address1 + *reinterpret_cast<const uint32_t *>(this->ROMData.get() + (StringID * 0x4) + Locs.Address2));
+		ShiftVal = *reinterpret_cast<const uint32_t *>(this->ROMData.get() + ShiftAddr);
 
 		do {
 			Character = 0x100;
 
 			do {
-				Character = *reinterpret_cast<uint16_t *>(this->ROMData.get() + (Character * 0x4) + Locs.Address3 - (((ShiftVal >> Counter) % 0x2) == 0 ? 0x400 : 0x3FE));
+				Character = *reinterpret_cast<const uint16_t *>(this->ROMData.get() + (Character * 0x4) + Locs.Address3 - (((ShiftVal >> Counter) % 0x2) == 0 ? 0x400 : 0x3FE));
 				Counter++;
+				TSGBAJPN_STAT(Bits++;)
 
 				if (Counter == 0x8) {
 					Counter = 0x0;
 					ShiftAddr++;
-					ShiftVal = *reinterpret_cast<uint32_t *>(this->ROMData.get() + ShiftAddr);
+					ShiftVal = *reinterpret_cast<const uint32_t *>(this->ROMData.get() + ShiftAddr);
 				}
 			} while (0xFF < Character);
 
@@ -138,10 +164,116 @@ std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
 		} while (Character != 0x0);
 	}
 
+	TSGBAJPN_STAT(
+		const uint64_t NS = ElapsedNS(Start);
+		this->Statistics.Fetches.fetch_add(1, std::memory_order_relaxed);
+		this->Statistics.BitsConsumed.fetch_add(Bits, std::memory_order_relaxed);
+		this->Statistics.BytesFetched.fetch_add(ResVec.size(), std::memory_order_relaxed);
+		this->Statistics.FetchTime.fetch_add(NS, std::memory_order_relaxed);
+		AddToHistogram(this->Statistics.FetchHistogram, NS);
+	)
+
 	return ResVec; // Return the uint8_t vector string.
 };
 
 
+/*
+	Constructor for TSGBAJPNStringWriter, which writes the header of the format.
+
+	FILE *Out: The file to write to.
+	const Formats Format: The format to write.
+	const size_t BufferSize: The size after which the buffer gets written to the file.
+*/
+TSGBAJPNStringWriter::TSGBAJPNStringWriter(FILE *Out, const TSGBAJPNStringWriter::Formats Format, const size_t BufferSize)
+	: Out(Out), Format(Format), BufferSize(BufferSize) {
+	this->Buffer.reserve(BufferSize + 0x1000);
+
+	if (this->Format == Formats::CSV) this->Buffer += "id,bytes\r\n";
+	else if (this->Format == Formats::PO) this->Buffer += "msgid \"\"\nmsgstr \"\"\n\"Content-Type: text/plain; charset=UTF-8\\n\"\n\n";
+};
+
+
+/*
+	Writes a string record.
+
+	JSON Lines: {"id":26,"bytes":"81, 82, 00"}
+	CSV:        0x1A,"81, 82, 00"
+	PO:         msgctxt "0x1A", msgid with the bytes and an empty msgstr.
+
+	const uint16_t StringID: The ID of the string.
+	const std::vector<uint8_t> &Bytes: The fetched raw string.
+*/
+void TSGBAJPNStringWriter::Write(const uint16_t StringID, const std::vector<uint8_t> &Bytes) {
+	char ID[8] = { '\0' };
+	char *IDEnd = std::to_chars(ID, ID + sizeof(ID), StringID, (this->Format == Formats::JSONLines ? 10 : 16)).ptr;
+	for (char *Digit = ID; Digit < IDEnd; Digit++) *Digit = toupper(*Digit); // Hexadecimal IDs are uppercase everywhere else.
+
+	switch(this->Format) {
+		case Formats::JSONLines:
+			this->Buffer += "{\"id\":";
+			this->Buffer.append(ID, IDEnd);
+			this->Buffer += ",\"bytes\":\"";
+			this->AppendHex(this->Buffer, Bytes);
+			this->Buffer += "\"}\n";
+			break;
+
+		case Formats::CSV:
+			this->Buffer += "0x";
+			this->Buffer.append(ID, IDEnd);
+			this->Buffer += ",\"";
+			this->AppendHex(this->Buffer, Bytes);
+			this->Buffer += "\"\r\n";
+			break;
+
+		case Formats::PO:
+			this->Buffer += "msgctxt \"0x";
+			this->Buffer.append(ID, IDEnd);
+			this->Buffer += "\"\nmsgid \"";
+			this->AppendHex(this->Buffer, Bytes);
+			this->Buffer += "\"\nmsgstr \"\"\n\n";
+			break;
+	}
+
+	if (this->Buffer.size() >= this->BufferSize) this->Flush();
+};
+
+
+/*
+	Writes the buffer to the file and empties it again, while keeping its capacity.
+
+	Returns false if any write so far failed, such as on a full disk. Once a write failed, nothing else gets written.
+*/
+bool TSGBAJPNStringWriter::Flush() {
+	if (!this->Out) this->Failed = true;
+	else if (!this->Failed && !this->Buffer.empty()) this->Failed = (fwrite(this->Buffer.data(), 0x1, this->Buffer.size(), this->Out) != this->Buffer.size());
+
+	this->Buffer.clear();
+	return !this->Failed;
+};
+
+
+void TSGBAJPNStringWriter::AppendHex(std::string &Dest, const std::vector<uint8_t> &Bytes) {
+	static constexpr char Hex[] = "0123456789ABCDEF";
+	if (Bytes.empty()) return;
+
+	/* Every byte except the last one takes 4 characters ("XX, "), so resize once and fill it directly. */
+	const size_t Start = Dest.size();
+	Dest.resize(Start + (Bytes.size() * 4) - 2);
+	char *Ptr = Dest.data() + Start;
+
+	for (size_t Idx = 0; Idx < Bytes.size(); Idx++) {
+		*Ptr++ = Hex[Bytes[Idx] >> 4];
+		*Ptr++ = Hex[Bytes[Idx] & 0xF];
+
+		if (Idx < Bytes.size() - 1) {
+			*Ptr++ = ',';
+			*Ptr++ = ' ';
+		}
+	}
+};
+
+
+
 /* Direct Use would include this int main. */
 #ifdef _DIRECT_USE
 
@@ -150,11 +282,44 @@ std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
 		return 0;
 	};
 
+	/* Prints a summary of TSGBAJPNStringFetcher::Stats with the fetch histogram, skipping the empty buckets. */
+	void PrintStats(const TSGBAJPNStringFetcher::Stats &Stats) {
+		if (!TSGBAJPNStringFetcher::StatsEnabled) {
+			printf("No stats available, compile with -D_STATS to get them.\n");
+			return;
+		}
+
+		const uint64_t Fetches = Stats.Fetches.load();
+		printf(
+			"\nStats:\n" \
+			"ROM Open: %llu ns, Validate: %llu ns, Read: %llu ns.\n" \
+			"Fetch: %llu calls, %llu bits consumed / tree nodes visited, %llu bytes emitted, %llu ns total, %llu ns average.\n",
+			(unsigned long long)Stats.OpenTime, (unsigned long long)Stats.ValidateTime, (unsigned long long)Stats.ReadTime,
+			(unsigned long long)Fetches, (unsigned long long)Stats.BitsConsumed.load(), (unsigned long long)Stats.BytesFetched.load(),
+			(unsigned long long)Stats.FetchTime.load(), (unsigned long long)(Fetches ? Stats.FetchTime.load() / Fetches : 0)
+		);
+
+		uint64_t Max = 0x0;
+		for (const auto &Bucket : Stats.FetchHistogram) Max = std::max<uint64_t>(Max, Bucket.load());
+		if (Max == 0x0) return;
+
+		printf("Fetch histogram:\n");
+		for (uint8_t Idx = 0; Idx < TSGBAJPNStringFetcher::Stats::HistogramBuckets; Idx++) {
+			const uint64_t Count = Stats.FetchHistogram[Idx].load();
+			if (Count == 0x0) continue;
+
+			printf("  < %12llu ns: %10llu %.*s\n", 1ULL << Idx, (unsigned long long)Count, (int)((Count * 40 + Max - 1) / Max),
+				"########################################");
+		}
+	};
+
 	int main(int Argc, char *Argv[]) {
 		if (Argc > 1) {
 			bool Provided[2] = { false, false };
+			bool ShowStats = false;
 
-			std::string ROMPath = "";
+			std::string ROMPath = "", DumpPath = "";
+			TSGBAJPNStringWriter::Formats DumpFormat = TSGBAJPNStringWriter::Formats::JSONLines;
 			uint16_t StringID = 0x0;
 
 			/* Go through all Arguments. */
@@ -163,7 +328,7 @@ std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
 
 				/* -i => Input. */
 				if (ARG == "-i" || ARG == "-input") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-i'.");
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-i'.");
 					ROMPath = Argv[Idx + 1];
 
 					Provided[0] = true;
@@ -172,7 +337,7 @@ std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
 
 				/* -id => String ID in hexadecimal. */
 				} else if (ARG == "-id") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-id'.");
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-id'.");
 					
 					StringID = strtoul(Argv[Idx + 1], nullptr, 16);
 
@@ -180,28 +345,75 @@ std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
 					Idx++;
 					continue;
 
+				/* -dump => Write all strings to a file. */
+				} else if (ARG == "-dump") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-dump'.");
+					DumpPath = Argv[Idx + 1];
+
+					Idx++;
+					continue;
+
+				/* -format => Format of the dump. */
+				} else if (ARG == "-format") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-format'.");
+					const std::string Format = Argv[Idx + 1];
+
+					if (Format == "jsonl" || Format == "json") DumpFormat = TSGBAJPNStringWriter::Formats::JSONLines;
+					else if (Format == "csv") DumpFormat = TSGBAJPNStringWriter::Formats::CSV;
+					else if (Format == "po") DumpFormat = TSGBAJPNStringWriter::Formats::PO;
+					else return AbortMain("No valid format has been provided with the parameter '-format'.");
+
+					Idx++;
+					continue;
+
+				/* -stats => Print the stats at the end. */
+				} else if (ARG == "-stats") {
+					ShowStats = true;
+					continue;
+
 				} else {
 					return AbortMain("Not a valid parameter provided.");
 				}
 			}
 
 			/* Ensure all needed parameters have been provided to work on. */
-			for (int8_t Idx = 0; Idx < 2; Idx++) {
+			for (int8_t Idx = 0; Idx < (DumpPath.empty() ? 2 : 1); Idx++) {
 				if (!Provided[Idx]) return AbortMain("Not all needed parameters have been provided.");
 			}
 
 			/* The actual action. */
 			std::unique_ptr<TSGBAJPNStringFetcher> Fetcher = std::make_unique<TSGBAJPNStringFetcher>(ROMPath);
 			if (Fetcher && Fetcher->SupportedGame()) {
+				if (!DumpPath.empty()) {
+					FILE *Out = fopen(DumpPath.c_str(), "wb");
+					if (!Out) return AbortMain("The dump file could not be created.");
+					setvbuf(Out, nullptr, _IONBF, 0); // TSGBAJPNStringWriter already buffers everything.
+
+					bool Written = false;
+					{
+						TSGBAJPNStringWriter Writer(Out, DumpFormat);
+						for (uint16_t ID = 0x0; ID <= Fetcher->GetMaxStringID(); ID++) Writer.Write(ID, Fetcher->Fetch(ID));
+						Written = Writer.Flush();
+					}
+
+					if (fclose(Out) != 0) Written = false;
+					if (!Written) return AbortMain("The dump file could not be written.");
+
+					printf("The strings have been dumped to %s.\n", DumpPath.c_str());
+					if (ShowStats) PrintStats(Fetcher->GetStats());
+					return 0;
+				}
+
 				if (StringID > Fetcher->GetMaxStringID()) return AbortMain("The String ID is too high.");
 				
 				std::vector<uint8_t> Fetched = Fetcher->Fetch(StringID);
 
-				printf("Your wanted string is:\n");
-				for (size_t Idx = 0; Idx < Fetched.size(); Idx++) {
-					if (Idx < Fetched.size() - 1) printf("%02X, ", Fetched[Idx]);
-					else printf("%02X\n", Fetched[Idx]);
-				}
+				std::string Output = "Your wanted string is:\n";
+				TSGBAJPNStringWriter::AppendHex(Output, Fetched);
+				Output += "\n";
+				fwrite(Output.data(), 0x1, Output.size(), stdout);
+
+				if (ShowStats) PrintStats(Fetcher->GetStats());
 
 			} else {
 				return AbortMain("The provided ROM is either not supported, trimmed or doesn't exist.");
@@ -210,11 +422,15 @@ std::vector<uint8_t> TSGBAJPNStringFetcher::Fetch(const uint16_t StringID) {
 		/* No arguments provided => Show info. */
 		} else {
 			printf(
-				"TSGBAJPNStringFetcher v0.2.0 by SuperSaiyajinStackZ, © 2021-2022.\n" \
+				"TSGBAJPNStringFetcher v0.3.0 by SuperSaiyajinStackZ, © 2021-2022.\n" \
 				"Purpose: 'Extract' in-game strings as raw bytes from The Sims Game Boy Advance Japanese games.\n\n" \
-				"Usage: -i <PathToROM> -id <Hexadecimal ID of the string>\n\n" \
+				"Usage: -i <PathToROM> -id <Hexadecimal ID of the string>\n" \
+				"Dump:  -i <PathToROM> -dump <PathToOutput> [-format <jsonl, csv or po>]\n\n" \
 				"Use -i or -input and then the path to the ROM to provide it as the ROM Source.\n" \
-				"Use -id to provide the ID of the string in hexadecimal format you want to fetch.\n"
+				"Use -id to provide the ID of the string in hexadecimal format you want to fetch.\n" \
+				"Use -dump to write all strings to a file.\n" \
+				"Use -format to provide the format of the dump: jsonl (default), csv or po.\n" \
+				"Use -stats to print the stats at the end (needs to be compiled with -D_STATS).\n"
 			);
 		}
 
@@ -27,20 +27,53 @@
 #ifndef _TSGBA_JPN_STRING_FETCHER_HPP
 #define _TSGBA_JPN_STRING_FETCHER_HPP
 
+#include <array> // std::array for the histogram of TSGBAJPNStringFetcher::Stats.
+#include <atomic> // std::atomic for the counters of TSGBAJPNStringFetcher::Stats.
 #include <memory> // std::unique_ptr because i like those instead of raw pointers.
 #include <string> // Default include, it's always in my projects.
 #include <vector> // std::vector for TSGBAJPNStringFetcher::Fetch.
 
 
+/* Compile with -D_STATS to fill TSGBAJPNStringFetcher::Stats, without it all the counting is removed at compile time. */
+#ifdef _STATS
+	#define TSGBAJPN_STAT(...) __VA_ARGS__
+#else
+	#define TSGBAJPN_STAT(...)
+#endif
+
 class TSGBAJPNStringFetcher {
 public:
 	enum class Games : uint8_t { BustinOut = 0, Urbz = 1, Invalid = 2 };
 
+	/*
+		Counters and timers of the fetcher, which only get filled when compiled with -D_STATS.
+		All times are in nanoseconds. Histogram bucket N counts the calls which took less than 2^N nanoseconds.
+		Each bit read from the ROM visits exactly one tree node, so BitsConsumed is also the amount of visited nodes.
+	*/
+	struct Stats {
+		static constexpr uint8_t HistogramBuckets = 0x20;
+		using Histogram = std::array<std::atomic<uint64_t>, HistogramBuckets>;
+
+		/* ROM Loading, filled by the constructor. */
+		uint64_t OpenTime = 0x0, ValidateTime = 0x0, ReadTime = 0x0;
+
+		/* Fetch. */
+		std::atomic<uint64_t> Fetches = 0x0, BitsConsumed = 0x0, BytesFetched = 0x0, FetchTime = 0x0;
+		Histogram FetchHistogram;
+	};
+	static constexpr bool StatsEnabled = TSGBAJPN_STAT(true ||) false;
+
 	TSGBAJPNStringFetcher(const std::string &ROMPath);
-	std::vector<uint8_t> Fetch(const uint16_t StringID);
+
+	/*
+		The ROM data never changes after the constructor, so Fetch is re-entrant.
+		One fetcher can be shared between as many threads as wanted without any locking.
+	*/
+	std::vector<uint8_t> Fetch(const uint16_t StringID) const;
 
 	Games DetectedGame() const { return this->ActiveGame; };
 	bool SupportedGame() const { return this->ActiveGame != Games::Invalid; };
+	const Stats &GetStats() const { return this->Statistics; };
 	uint16_t GetMaxStringID() const {
 		switch(this->ActiveGame) {
 			case Games::BustinOut:
@@ -56,7 +89,8 @@ public:
 	};
 private:
 	Games ActiveGame = Games::Invalid;
-	std::unique_ptr<uint8_t[]> ROMData = nullptr;
+	std::unique_ptr<const uint8_t[]> ROMData = nullptr;
+	mutable Stats Statistics; // Mutable, because the const Fetch counts into it too.
 	static constexpr uint8_t TIDs[2][4] = {
 		{ 0x42, 0x34, 0x50, 0x4A }, // The Sims Bustin' Out. JPN.
 		{ 0x42, 0x4F, 0x43, 0x4A } // The Urbz - Sims in the City JPN.
@@ -95,4 +129,31 @@ private:
 	};
 };
 
+
+/*
+	Buffered writer to dump fetched raw strings as JSON Lines, CSV or gettext PO, with the bytes written as hex like "81, 82, 00".
+
+	All records get formatted into one large buffer, which is reused and only written out with a single fwrite once it's full,
+	so dumping doesn't do a syscall or an allocation per record.
+*/
+class TSGBAJPNStringWriter {
+public:
+	enum class Formats : uint8_t { JSONLines = 0, CSV = 1, PO = 2 };
+
+	TSGBAJPNStringWriter(FILE *Out, const Formats Format, const size_t BufferSize = 0x100000);
+	~TSGBAJPNStringWriter() { this->Flush(); };
+
+	void Write(const uint16_t StringID, const std::vector<uint8_t> &Bytes);
+	bool Flush();
+
+	/* Appends the bytes as uppercase hex separated by ", " to Dest. */
+	static void AppendHex(std::string &Dest, const std::vector<uint8_t> &Bytes);
+private:
+	FILE *Out = nullptr;
+	Formats Format = Formats::JSONLines;
+	size_t BufferSize = 0x0;
+	std::string Buffer = "";
+	bool Failed = false; // Sticky, so a failed write can't be missed by only checking the last Flush.
+};
+
 #endif
\ No newline at end of file
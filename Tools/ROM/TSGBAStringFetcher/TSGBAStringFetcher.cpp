@@ -31,149 +31,1602 @@
 	------------------------------------
 	File: TSGBAStringFetcher.cpp | TSGBAStringFetcher.hpp
 	Authors: SuperSaiyajinStackZ
-	Version: 0.3.0
+	Version: 0.6.0
 	Purpose: "Extract" in-game strings from The Sims Game Boy Advance games.
 	Category: ROM Tools
-	Last Updated: 05 December 2021
+	Last Updated: 18 October 2026
 	------------------------------------
 
 	To compile this, run:
-	g++ -D_DIRECT_USE -std=c++20 TSGBAStringFetcher.cpp -o TSGBAStringFetcher.exe
+	g++ -D_DIRECT_USE -std=c++20 -pthread TSGBAStringFetcher.cpp -o TSGBAStringFetcher.exe
 	^ If you want to use your own int main, then don't include -D_DIRECT_USE.
+	^ Add -D_STATS to fill the stats of the fetcher, which can be printed with the -stats parameter.
+	^ Add -D_ARCHIVE_SUPPORT and -lz (zlib) at the end to load .gz and .zip compressed ROMs directly.
+	^ Add -D_PAGE_TRACE to record which ROM pages get read, which can be written to a page profile with the -trace parameter.
 */
 
 
 #include "TSGBAStringFetcher.hpp" // Header of this file.
-#include <cstring> // memcmp to compare the ROM's TID.
+#include <algorithm> // std::sort for the page profiles and the batches of TSGBAStringFetcher::FetchAsync.
+#include <atomic> // std::atomic for the progress of the other side in TSGBAStringFetcher::Diff.
+#include <bit> // std::bit_width for the histogram buckets of TSGBAStringFetcher::Stats.
+#include <charconv> // std::to_chars for the String IDs of TSGBAStringWriter.
+#include <chrono> // std::chrono::steady_clock for the timers of TSGBAStringFetcher::Stats.
+#include <condition_variable> // std::condition_variable to wake up the TSGBAStringFetcher::AsyncExecutor thread.
+#include <deque> // std::deque for the queued requests of TSGBAStringFetcher::AsyncExecutor.
+#include <filesystem> // std::filesystem::path to split the ROM path for TSGBAStringWatcher::Watch.
+#include <mutex> // std::mutex for the queued requests of TSGBAStringFetcher::AsyncExecutor.
+#include <thread> // std::thread to fetch the other side in TSGBAStringFetcher::Diff and for the stages of TSGBAStringDumper.
 #include <unistd.h> // access() to check for ROM File existence.
+#include <vector> // std::vector for the fetched strings of the other side in TSGBAStringFetcher::Diff.
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h> // AVX2 gathers for TSGBAStringFetcher::FetchRawAVX2, which gets picked at runtime.
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <sys/mman.h> // mmap() and madvise() to map the ROM and read the pages of a page profile ahead.
+	#include <sys/stat.h> // fstat() to check the size of the ROM again right before mapping it.
+#endif
+
+#ifdef __linux__
+	#include <poll.h> // poll() to wait for inotify events with a timeout.
+	#include <sys/inotify.h> // inotify to get notified about ROM changes in TSGBAStringWatcher::Watch.
+#endif
+
+#ifdef _ARCHIVE_SUPPORT
+	#include <zlib.h> // inflate to load the ROM straight from .gz and .zip archives.
+#endif
+
+
+#ifdef _STATS
+	/* Returns the nanoseconds which passed since Start. */
+	static uint64_t ElapsedNS(const std::chrono::steady_clock::time_point &Start) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count();
+	};
+
+	/* Adds a call which took NS nanoseconds to the histogram. */
+	static void AddToHistogram(TSGBAStringFetcher::Stats::Histogram &Hist, const uint64_t NS) {
+		const uint8_t Bucket = std::min<uint8_t>(std::bit_width(NS), TSGBAStringFetcher::Stats::HistogramBuckets - 1);
+		Hist[Bucket].fetch_add(1, std::memory_order_relaxed);
+	};
+#endif
+
+
+
+/*
+	The background executor of FetchAsync.
+
+	Requests get queued and a single thread takes all requests which are queued at that moment as one batch.
+	The IDs of the whole batch get grouped by language and deduplicated, so each wanted string only gets fetched once with FetchBulk,
+	and then the promises get fulfilled in the order they were queued.
+	The thread only gets started with the first FetchAsync call, so fetchers which never use it don't have an extra thread.
+*/
+struct TSGBAStringFetcher::AsyncExecutor {
+	struct Request {
+		std::vector<uint16_t> StringIDs;
+		TSGBAStringFetcher::Languages Language;
+		std::promise<std::vector<std::string>> Promise;
+	};
+
+	std::mutex Lock;
+	std::condition_variable Wake;
+	std::deque<Request> Queue;
+	std::thread Worker;
+	bool Stop = false;
+
+	/* The sorted unique IDs of a batch and their fetched strings for each language, kept to reuse their capacity. */
+	std::array<std::vector<uint16_t>, TSGBAStringFetcher::LanguageAmount> Wanted;
+	std::array<std::vector<std::string>, TSGBAStringFetcher::LanguageAmount> Fetched;
+
+	void FetchBatch(const TSGBAStringFetcher &Fetcher, std::deque<Request> &Batch);
+};
+
+
+/*
+	Fetches all requests of a batch and fulfills their promises in the order they were queued.
+
+	const TSGBAStringFetcher &Fetcher: The fetcher to fetch with.
+	std::deque<Request> &Batch: The requests to fetch.
+*/
+void TSGBAStringFetcher::AsyncExecutor::FetchBatch(const TSGBAStringFetcher &Fetcher, std::deque<Request> &Batch) {
+	for (std::vector<uint16_t> &IDs : this->Wanted) IDs.clear();
+	for (const Request &Req : Batch) {
+		std::vector<uint16_t> &IDs = this->Wanted[Fetcher.LangIdx(Req.Language)];
+		IDs.insert(IDs.end(), Req.StringIDs.begin(), Req.StringIDs.end());
+	}
+
+	/* Consecutive IDs get fetched with a single FetchBulk call, so the lanes of it can be filled. */
+	for (uint8_t Lang = 0; Lang < TSGBAStringFetcher::LanguageAmount; Lang++) {
+		std::vector<uint16_t> &IDs = this->Wanted[Lang];
+		if (IDs.empty()) continue;
+
+		std::sort(IDs.begin(), IDs.end());
+		IDs.erase(std::unique(IDs.begin(), IDs.end()), IDs.end());
+		this->Fetched[Lang].resize(IDs.size());
+
+		for (size_t Start = 0x0, End = 0x0; Start < IDs.size(); Start = End) {
+			for (End = Start + 1; End < IDs.size() && IDs[End] == IDs[End - 1] + 1; End++);
+			Fetcher.FetchBulk(IDs[Start], End - Start, (TSGBAStringFetcher::Languages)Lang, this->Fetched[Lang].data() + Start);
+		}
+	}
+
+	for (Request &Req : Batch) {
+		const std::vector<uint16_t> &IDs = this->Wanted[Fetcher.LangIdx(Req.Language)];
+		const std::vector<std::string> &Strings = this->Fetched[Fetcher.LangIdx(Req.Language)];
+
+		std::vector<std::string> Result;
+		Result.reserve(Req.StringIDs.size());
+		for (const uint16_t StringID : Req.StringIDs) Result.push_back(Strings[std::lower_bound(IDs.begin(), IDs.end(), StringID) - IDs.begin()]);
+
+		Req.Promise.set_value(std::move(Result));
+	}
+};
+
+
+
+/*
+	Constructor for TSGBAStringFetcher, which checks the passed ROM for validation and loads it into RAM.
+	When compiled with -D_ARCHIVE_SUPPORT, the ROM may also be compressed as .gz or .zip.
+
+	const std::string &ROMPath: The path to the ROM to load.
+	const std::string &ProfilePath: If not empty, a page profile of WritePageProfile. The ROM then gets mapped instead of read
+		and only the pages of the profile get read ahead, the others once they get used. Ignored for archives and on Windows.
+		NOTE: A mapped ROM still reads from the file, so the fetcher must not be used anymore once the ROM file gets changed or replaced in place.
+		Changed bytes would show up in the middle of a Fetch, and a shrunk file crashes it with SIGBUS. Leave it empty to read the ROM once.
+*/
+TSGBAStringFetcher::TSGBAStringFetcher(const std::string &ROMPath, const std::string &ProfilePath) : Executor(std::make_unique<AsyncExecutor>()) {
+	TSGBA_STAT(auto Start = std::chrono::steady_clock::now();)
+	if (access(ROMPath.c_str(), F_OK) != 0) return;
+
+	FILE *In = fopen(ROMPath.c_str(), "rb");
+
+	if (In) {
+		fseek(In, 0, SEEK_END);
+		const uint32_t Size = ftell(In);
+		fseek(In, 0, SEEK_SET);
+		TSGBA_STAT(this->Statistics.OpenTime = ElapsedNS(Start); Start = std::chrono::steady_clock::now();)
+
+		#ifdef _ARCHIVE_SUPPORT
+			/* Check for the gzip (1F 8B) or zip (PK 03 04) signature. */
+			uint8_t Signature[4] = { 0x0 };
+			const bool HasSignature = fread(Signature, 0x1, 0x4, In) == 0x4;
+			fseek(In, 0, SEEK_SET);
+
+			if (HasSignature && ((Signature[0] == 0x1F && Signature[1] == 0x8B) || memcmp(Signature, "PK\x03\x04", 0x4) == 0)) {
+				this->LoadArchive(In, Signature[0] == 'P');
+				fclose(In);
+				return;
+			}
+		#endif
+
+		if (Size >= this->MinROMSize && Size <= this->MaxROMSize) {
+			/* Check for the Magic Byte at 0xB2 that it's 0x96. */
+			uint8_t MagicByte = 0x0;
+			fseek(In, 0xB2, SEEK_SET);
+			fread(&MagicByte, 0x1, 0x1, In);
+			fseek(In, 0, SEEK_SET);
+
+			if (MagicByte == 0x96) {
+				uint8_t IDFromROM[4] = { '\0' };
+				fseek(In, 0xAC, SEEK_SET);
+				fread(&IDFromROM, 0x1, 0x4, In);
+				fseek(In, 0, SEEK_SET);
+
+				/* Check the Title ID of the ROM. */
+				this->ActiveGame = this->GameFromTID(IDFromROM);
+				TSGBA_STAT(this->Statistics.ValidateTime = ElapsedNS(Start); Start = std::chrono::steady_clock::now();)
+
+				if (this->SupportedGame()) {
+					#if defined(__unix__) || defined(__APPLE__)
+						if (!ProfilePath.empty()) this->MapROM(In, Size, ProfilePath);
+					#endif
+
+					if (!this->ROMData) {
+						std::unique_ptr<uint8_t[]> Data = std::make_unique<uint8_t[]>(Size);
+						fread(Data.get(), 0x1, Size, In);
+						this->ROMData.reset(Data.release());
+					}
+
+					this->FinishLoad(Size);
+					TSGBA_STAT(this->Statistics.ReadTime = ElapsedNS(Start);)
+				}
+			}
+		}
+
+		fclose(In);
+	}
+};
+
+
+
+#ifdef _ARCHIVE_SUPPORT
+	/* Reads a little endian 16 / 32 bit value, for the zip local file header. */
+	static uint16_t Read16(const uint8_t *Data) { return Data[0] | (Data[1] << 8); };
+	static uint32_t Read32(const uint8_t *Data) { return Read16(Data) | (Read16(Data + 2) << 16); };
+
+	/*
+		Loads the ROM from a .gz or .zip archive by inflating it straight into the ROM buffer, without any temporary file.
+
+		The header gets checked as soon as the first 0xC0 bytes are inflated, so unsupported ROMs are
+		rejected without inflating the rest of it. For zip, only the first file of the archive gets loaded.
+		Damaged archives get rejected: zlib checks the CRC-32 of gzip and the one of zip gets calculated while inflating.
+
+		FILE *In: The opened archive, at the start.
+		const bool IsZip: If it's a zip (true) or gzip (false) archive.
+	*/
+	void TSGBAStringFetcher::LoadArchive(FILE *In, const bool IsZip) {
+		TSGBA_STAT(auto Start = std::chrono::steady_clock::now();)
+		z_stream Stream = { };
+		uint32_t Expected = 0x0; // The size of the ROM, if the archive tells it before inflating.
+		uint32_t ExpectedCRC = 0x0; // The CRC-32 of a zip entry, zlib checks the one of gzip itself.
+		bool Stored = false, Descriptor = false;
+
+		if (IsZip) {
+			uint8_t Header[0x1E] = { 0x0 };
+			if (fread(Header, 0x1, sizeof(Header), In) != sizeof(Header)) return;
+
+			const uint16_t Method = Read16(Header + 0x8);
+			if (Method != 0x0 && Method != 0x8) return; // Only stored and deflated files are supported.
+
+			/* With bit 3 of the flags, the CRC-32 and sizes are only in the data descriptor after the data, and 0xFFFFFFFF means zip64. */
+			Descriptor = (Read16(Header + 0x6) & 0x8);
+			if (!Descriptor) {
+				Expected = Read32(Header + 0x16);
+				ExpectedCRC = Read32(Header + 0xE);
+			}
+
+			if (Expected == 0xFFFFFFFF) Expected = 0x0;
+			Stored = (Method == 0x0);
+			if (Stored && Expected == 0x0) return;
+
+			fseek(In, Read16(Header + 0x1A) + Read16(Header + 0x1C), SEEK_CUR); // Skip the file name and extra field.
+			if (!Stored && inflateInit2(&Stream, -MAX_WBITS) != Z_OK) return;
+
+		} else {
+			/* The last 4 bytes of a gzip file are the uncompressed size. */
+			uint8_t Size[4] = { 0x0 };
+			fseek(In, -4, SEEK_END);
+			if (fread(Size, 0x1, 0x4, In) == 0x4) Expected = Read32(Size);
+			fseek(In, 0, SEEK_SET);
+
+			if (inflateInit2(&Stream, 16 + MAX_WBITS) != Z_OK) return;
+		}
+
+		if (Expected != 0x0 && (Expected < this->MinROMSize || Expected > this->MaxROMSize)) {
+			if (!Stored) inflateEnd(&Stream);
+			return;
+		}
+
+		/*
+			Inflating gets one byte more room than the ROM can have, so it always gets to the end of the stream,
+			where zlib checks the CRC-32 of gzip and the data descriptor of zip starts. Too large ROMs fill it and get rejected.
+		*/
+		const uint32_t Capacity = (Expected != 0x0 ? Expected : this->MaxROMSize) + (Stored ? 0x0 : 0x1);
+		std::unique_ptr<uint8_t[]> Data = std::make_unique_for_overwrite<uint8_t[]>(Capacity); // No need to zero it, it gets inflated into.
+		uint32_t Size = 0x0, CRC = crc32(0L, Z_NULL, 0);
+		bool Valid = false, Done = false, Abort = false;
+
+		if (Stored) {
+			Size = fread(Data.get(), 0x1, Capacity, In);
+			CRC = crc32(CRC, Data.get(), Size);
+			Done = (Size == Capacity);
+
+		} else {
+			std::unique_ptr<uint8_t[]> Chunk = std::make_unique<uint8_t[]>(0x10000);
+
+			while (!Done && !Abort && Stream.total_out < Capacity) {
+				Stream.avail_in = fread(Chunk.get(), 0x1, 0x10000, In);
+				Stream.next_in = Chunk.get();
+				if (Stream.avail_in == 0) break;
+
+				while (Stream.avail_in > 0 && Stream.total_out < Capacity) {
+					/* Until the header has been checked, only inflate the first 0x100 bytes, so unsupported ROMs are not inflated entirely. */
+					const uint32_t Before = Stream.total_out;
+					Stream.next_out = Data.get() + Stream.total_out;
+					Stream.avail_out = (Valid ? Capacity : 0x100) - Stream.total_out;
+
+					const int Res = inflate(&Stream, Z_NO_FLUSH);
+					CRC = crc32(CRC, Data.get() + Before, Stream.total_out - Before); // While the bytes are still in the cache.
+					if (Res == Z_STREAM_END) Done = true;
+					else if (Res != Z_OK) Abort = true;
+
+					if (!Valid && !Abort && Stream.total_out >= 0xC0) {
+						if (Data[0xB2] != 0x96 || this->GameFromTID(Data.get() + 0xAC) == Games::Invalid) Abort = true;
+						Valid = true;
+						TSGBA_STAT(this->Statistics.ValidateTime = ElapsedNS(Start); Start = std::chrono::steady_clock::now();)
+					}
+
+					if (Done || Abort) break;
+				}
+			}
+
+			/* The data descriptor follows right after the deflated data, optionally with its signature: CRC-32, compressed and uncompressed size. */
+			if (Done && Descriptor) {
+				uint8_t Desc[0x10] = { 0x0 };
+				const uint32_t Buffered = std::min<uint32_t>(Stream.avail_in, sizeof(Desc));
+
+				memcpy(Desc, Stream.next_in, Buffered);
+				if (Buffered + fread(Desc + Buffered, 0x1, sizeof(Desc) - Buffered, In) < 0xC) Done = false;
+				ExpectedCRC = Read32(Desc + (Read32(Desc) == 0x08074B50 ? 0x4 : 0x0));
+			}
+
+			Size = Stream.total_out;
+			inflateEnd(&Stream);
+		}
+
+		if (Abort || !Done || Size < this->MinROMSize || Size > this->MaxROMSize || (Expected != 0x0 && Size != Expected)) return;
+		if (IsZip && CRC != ExpectedCRC) return; // Damaged data.
+		if (Data[0xB2] != 0x96) return;
+
+		this->ActiveGame = this->GameFromTID(Data.get() + 0xAC);
+		if (this->SupportedGame()) {
+			this->ROMData.reset(Data.release());
+			this->FinishLoad(Size);
+			TSGBA_STAT(this->Statistics.ReadTime = ElapsedNS(Start);)
+		}
+	};
+#endif
+
+
+/* Sets up everything which depends on the loaded ROM, after ROMData got filled. */
+void TSGBAStringFetcher::FinishLoad(const uint32_t Size) {
+	this->ROMSize = Size;
+	this->Templates = std::make_unique<std::atomic<const StringTemplate *>[]>(this->LanguageAmount * (this->GetMaxStringID() + 1));
+
+	TSGBA_TRACE(
+		const size_t Pages = (size_t)this->LanguageAmount * ((Size + PageSize - 1) / PageSize);
+		this->PageReads = std::make_unique<std::atomic<uint32_t>[]>(Pages);
+		this->PageOrder = std::make_unique<std::atomic<uint32_t>[]>(Pages);
+	)
+};
+
+
+void TSGBAStringFetcher::ROMRelease::operator()(const uint8_t *Data) const {
+	#if defined(__unix__) || defined(__APPLE__)
+		if (this->Mapped) {
+			munmap(const_cast<uint8_t *>(Data), this->Mapped);
+			return;
+		}
+	#endif
+
+	delete[] Data;
+};
+
+
+#if defined(__unix__) || defined(__APPLE__)
+	/*
+		Maps the ROM instead of reading all of it, and tells the kernel to read the pages of the page profile ahead
+		in the order they got read first when the profile was made. All other pages only get read once they are used.
+		Unlike a read ROM, the mapping is not a copy: the ROM file must not be changed while the fetcher is used, see the constructor.
+		Leaves ROMData empty if the profile does not match the ROM or mapping fails, so the ROM gets read like without a profile.
+
+		FILE *In: The opened ROM, the mapping stays valid after closing it.
+		const uint32_t Size: The size of the ROM.
+		const std::string &ProfilePath: The path to the page profile.
+	*/
+	void TSGBAStringFetcher::MapROM(FILE *In, const uint32_t Size, const std::string &ProfilePath) {
+		FILE *Profile = fopen(ProfilePath.c_str(), "r");
+		if (!Profile) return;
+
+		/* The first line which is not a comment has the TID and size of the ROM the profile was made with. */
+		char Line[0x100] = { '\0' }, TID[5] = { '\0' };
+		uint32_t ProfileSize = 0x0;
+		bool HeaderRead = false;
+		std::vector<std::pair<uint32_t, uint32_t>> Pages; // The order of the first read and the page.
+
+		while (fgets(Line, sizeof(Line), Profile)) {
+			if (Line[0] == '#') continue;
+
+			if (!HeaderRead) {
+				if (sscanf(Line, "%4s %x", TID, &ProfileSize) != 2 || memcmp(TID, this->TIDs[(uint8_t)this->ActiveGame], 0x4) != 0 || ProfileSize != Size) break;
+				HeaderRead = true;
+				continue;
+			}
+
+			uint32_t Page = 0x0, Reads = 0x0, Order = 0x0;
+			if (sscanf(Line, "%*s %x %u %u", &Page, &Reads, &Order) == 3 && Page < (Size + PageSize - 1) / PageSize) Pages.push_back({ Order, Page });
+		}
+
+		fclose(Profile);
+		if (Pages.empty()) return;
+
+		/* The ROM might have been changed since its size got checked, and mapping past the end of the file would crash on the first read there. */
+		struct stat Info;
+		if (fstat(fileno(In), &Info) != 0 || (uint64_t)Info.st_size != Size) return;
+
+		void *Mapped = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fileno(In), 0);
+		if (Mapped == MAP_FAILED) return;
+
+		this->ROMData = std::unique_ptr<const uint8_t[], ROMRelease>(static_cast<const uint8_t *>(Mapped), ROMRelease{ Size });
+		madvise(Mapped, Size, MADV_RANDOM); // No read ahead around the pages which are used, the profile knows better.
+
+		/* Pages read by multiple languages only get read ahead once, and neighbouring pages get read ahead together. */
+		std::sort(Pages.begin(), Pages.end());
+		std::vector<bool> Seen((Size + PageSize - 1) / PageSize, false);
+		uint32_t RunStart = 0x0, RunLength = 0x0;
+
+		for (const auto &[Order, Page] : Pages) {
+			if (Seen[Page]) continue;
+			Seen[Page] = true;
+			this->PrefetchedPages++;
+
+			if (RunLength > 0x0 && Page == RunStart + RunLength) {
+				RunLength++;
+				continue;
+			}
+
+			if (RunLength > 0x0) madvise(static_cast<uint8_t *>(Mapped) + (RunStart * PageSize), RunLength * PageSize, MADV_WILLNEED);
+			RunStart = Page;
+			RunLength = 0x1;
+		}
+
+		if (RunLength > 0x0) madvise(static_cast<uint8_t *>(Mapped) + (RunStart * PageSize), RunLength * PageSize, MADV_WILLNEED);
+	};
+#endif
+
+
+#ifdef _PAGE_TRACE
+	/*
+		Records a read of the page that contains Offset for WritePageProfile.
+
+		const Languages Language: The language the read was for.
+		const uint32_t Offset: The ROM offset that got read.
+	*/
+	void TSGBAStringFetcher::TracePage(const TSGBAStringFetcher::Languages Language, const uint32_t Offset) const {
+		const size_t Idx = (this->LangIdx(Language) * ((this->ROMSize + PageSize - 1) / PageSize)) + (Offset / PageSize);
+		if (this->PageReads[Idx].fetch_add(1, std::memory_order_relaxed) == 0x0) this->PageOrder[Idx].store(++this->PagesSeen, std::memory_order_relaxed);
+	};
+#endif
+
+
+/*
+	Writes the page trace as a page profile, which can be passed to the constructor to read those pages ahead the next time.
+	Each line is the language, the page (ROM offset / PageSize), how often it got read and the order in which it got read first,
+	sorted by that order. Only available when compiled with -D_PAGE_TRACE.
+
+	const std::string &ProfilePath: The path to write the profile to.
+
+	Returns false if the profile could not be written or tracing is not compiled in.
+*/
+bool TSGBAStringFetcher::WritePageProfile(const std::string &ProfilePath) const {
+	#ifdef _PAGE_TRACE
+		if (!this->SupportedGame() || !this->PageReads) return false;
+
+		struct Entry {
+			uint32_t Order = 0x0;
+			uint32_t Reads = 0x0;
+			uint32_t Page = 0x0;
+			uint8_t Language = 0x0;
+		};
+
+		const uint32_t PageAmount = (this->ROMSize + PageSize - 1) / PageSize;
+		std::vector<Entry> Entries;
+
+		for (uint8_t Lang = 0; Lang < this->LanguageAmount; Lang++) {
+			for (uint32_t Page = 0x0; Page < PageAmount; Page++) {
+				const uint32_t Reads = this->PageReads[(Lang * PageAmount) + Page].load(std::memory_order_relaxed);
+				if (Reads > 0x0) Entries.push_back({ this->PageOrder[(Lang * PageAmount) + Page].load(std::memory_order_relaxed), Reads, Page, Lang });
+			}
+		}
+
+		std::sort(Entries.begin(), Entries.end(), [](const Entry &A, const Entry &B) { return A.Order < B.Order; });
+
+		FILE *Out = fopen(ProfilePath.c_str(), "w");
+		if (!Out) return false;
+
+		fprintf(Out, "# TSGBAStringFetcher page profile with 0x%X byte pages: language, page, reads, order of the first read.\n", PageSize);
+		fprintf(Out, "%.4s %X\n", reinterpret_cast<const char *>(this->TIDs[(uint8_t)this->ActiveGame]), this->ROMSize);
+		for (const Entry &E : Entries) fprintf(Out, "%s %X %u %u\n", TSGBAStringWriter::LanguageNames[E.Language], E.Page, E.Reads, E.Order);
+
+		return fclose(Out) == 0;
+	#else
+		(void)ProfilePath;
+		return false;
+	#endif
+};
+
+
+
+/*
+	Destructor for TSGBAStringFetcher, which finishes the still queued FetchAsync requests, stops the background thread
+	and frees the cached templates.
+*/
+TSGBAStringFetcher::~TSGBAStringFetcher() {
+	if (this->Executor) {
+		{
+			std::lock_guard<std::mutex> Guard(this->Executor->Lock);
+			this->Executor->Stop = true;
+		}
+
+		this->Executor->Wake.notify_one();
+		if (this->Executor->Worker.joinable()) this->Executor->Worker.join();
+	}
+
+	if (this->Templates) {
+		for (size_t Idx = 0; Idx < (size_t)this->LanguageAmount * (this->GetMaxStringID() + 1); Idx++) delete this->Templates[Idx].load();
+	}
+
+	for (const auto &Table : this->BulkTables) {
+		if (Table.load() != &MalformedTree) delete Table.load();
+	}
+};
+
+
+
+/*
+	Fetches a string from the ROM.
+
+	const uint16_t StringID: The ID of the string to fetch.
+	const Languages Language: The language to fetch.
+
+	Returns a std::string with the wanted string.
+*/
+std::string TSGBAStringFetcher::Fetch(const uint16_t StringID, const TSGBAStringFetcher::Languages Language) const {
+	return this->Decode(this->FetchRaw(StringID, Language)); // Return the decoded string.
+};
+
+
+/*
+	Fetches many strings after each other, with the same results as calling Fetch for each of them but faster.
+	The encoded bytes get fetched 4 bits at a time with the BulkTable of the language, with FetchRawAVX2 if the CPU supports AVX2
+	and with FetchRawInterleaved otherwise.
+
+	const uint16_t FirstID: The ID of the first string to fetch.
+	const uint16_t Amount: The amount of strings to fetch.
+	const Languages Language: The language to fetch.
+	std::string *Results: Where the strings get stored, needs to have room for Amount strings. IDs above the max get an empty string.
+*/
+void TSGBAStringFetcher::FetchBulk(const uint16_t FirstID, const uint16_t Amount, const TSGBAStringFetcher::Languages Language, std::string *Results) const {
+	for (uint16_t Idx = 0; Idx < Amount; Idx++) Results[Idx].clear();
+	if (!this->SupportedGame() || !this->ROMData || FirstID > this->GetMaxStringID()) return;
+
+	const uint16_t Valid = std::min<uint32_t>(Amount, this->GetMaxStringID() + 1 - FirstID);
+	const BulkTable *Table = (TraceEnabled ? nullptr : this->GetBulkTable(Language)); // The page trace only records the reads of FetchRaw.
+
+	if (!Table) {
+		for (uint16_t Idx = 0; Idx < Valid; Idx++) Results[Idx] = this->Fetch(FirstID + Idx, Language);
+		return;
+	}
+
+	const StringLocs Locs = this->GetLocForGame(Language);
+	TSGBA_STAT(const auto Start = std::chrono::steady_clock::now();)
+	uint64_t Bits = 0x0;
+
+	#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		static const bool HasAVX2 = __builtin_cpu_supports("avx2");
+		Bits = (HasAVX2 ? this->FetchRawAVX2(FirstID, Valid, Locs, *Table, Results) : this->FetchRawInterleaved(FirstID, Valid, Locs, *Table, Results));
+	#else
+		Bits = this->FetchRawInterleaved(FirstID, Valid, Locs, *Table, Results);
+	#endif
+
+	/* No histogram entries here, as the time of a single string is not known. */
+	TSGBA_STAT(
+		size_t Bytes = 0x0;
+		for (uint16_t Idx = 0; Idx < Valid; Idx++) Bytes += Results[Idx].size();
+
+		this->Statistics.Fetches.fetch_add(Valid, std::memory_order_relaxed);
+		this->Statistics.BitsConsumed.fetch_add(Bits, std::memory_order_relaxed);
+		this->Statistics.BytesFetched.fetch_add(Bytes, std::memory_order_relaxed);
+		this->Statistics.FetchTime.fetch_add(ElapsedNS(Start), std::memory_order_relaxed);
+	)
+	(void)Bits;
+
+	/* Decode into a scratch string and swap it in, so the strings of Results get reused instead of replaced by new ones. */
+	std::string Decoded;
+	for (uint16_t Idx = 0; Idx < Valid; Idx++) {
+		this->Decode(Results[Idx], Decoded);
+		Results[Idx].swap(Decoded);
+	}
+};
+
+
+
+/*
+	Fetches multiple strings from the ROM on a background thread, without blocking the caller.
+	Requests which come in while the background thread is busy get fetched together as one batch, where each string only gets fetched once.
+	The futures get their results in the order the requests were made.
+
+	std::vector<uint16_t> StringIDs: The IDs of the strings to fetch.
+	const Languages Language: The language to fetch.
+
+	Returns a std::future with the wanted strings in the same order as StringIDs.
+*/
+std::future<std::vector<std::string>> TSGBAStringFetcher::FetchAsync(std::vector<uint16_t> StringIDs, const TSGBAStringFetcher::Languages Language) const {
+	std::future<std::vector<std::string>> Result;
+
+	{
+		std::lock_guard<std::mutex> Guard(this->Executor->Lock);
+		this->Executor->Queue.push_back({ std::move(StringIDs), Language, { } });
+		Result = this->Executor->Queue.back().Promise.get_future();
+
+		if (!this->Executor->Worker.joinable()) {
+			this->Executor->Worker = std::thread([this]() {
+				std::deque<AsyncExecutor::Request> Batch;
+
+				while (true) {
+					{
+						std::unique_lock<std::mutex> Guard(this->Executor->Lock);
+						this->Executor->Wake.wait(Guard, [this]() { return this->Executor->Stop || !this->Executor->Queue.empty(); });
+						if (this->Executor->Queue.empty()) return; // Only stop once everything queued has been fetched.
+
+						Batch.swap(this->Executor->Queue);
+					}
+
+					this->Executor->FetchBatch(*this, Batch);
+					Batch.clear();
+				}
+			});
+		}
+	}
+
+	this->Executor->Wake.notify_one();
+	return Result;
+};
+
+
+
+/*
+	Fetches a string as a template, split at its '@' formatting parameters, which can then be filled in with Format.
+	The template only gets parsed once and then stays cached for the lifetime of the fetcher, so repeatedly rendering a string is cheap.
+
+	const uint16_t StringID: The ID of the string to fetch.
+	const Languages Language: The language to fetch.
+
+	Returns a pointer to the template, or nullptr if the ROM or ID is invalid.
+*/
+const TSGBAStringFetcher::StringTemplate *TSGBAStringFetcher::FetchTemplate(const uint16_t StringID, const TSGBAStringFetcher::Languages Language) const {
+	if (!this->Templates || StringID > this->GetMaxStringID()) return nullptr;
+
+	std::atomic<const StringTemplate *> &Cached = this->Templates[(this->LangIdx(Language) * (this->GetMaxStringID() + 1)) + StringID];
+	const StringTemplate *Template = Cached.load(std::memory_order_acquire);
+
+	if (Template) {
+		TSGBA_STAT(this->Statistics.CacheHits.fetch_add(1, std::memory_order_relaxed);)
+		return Template;
+	}
+
+	TSGBA_STAT(this->Statistics.CacheMisses.fetch_add(1, std::memory_order_relaxed);)
+	StringTemplate *New = new StringTemplate();
+	New->Text = this->Fetch(StringID, Language);
+	while (!New->Text.empty() && New->Text.back() == '\0') New->Text.pop_back(); // The 0x0 terminator is not part of the text.
+
+	/* Split the text into literal parts and '@' followed by the number of the parameter. */
+	size_t LiteralStart = 0x0;
+	for (size_t Idx = 0; Idx < New->Text.size(); Idx++) {
+		if (New->Text[Idx] != '@' || Idx + 1 >= New->Text.size() || !isdigit((uint8_t)New->Text[Idx + 1])) continue;
+
+		size_t End = Idx + 1;
+		uint32_t Param = 0x0;
+		while (End < New->Text.size() && isdigit((uint8_t)New->Text[End]) && Param <= 0xFF) Param = (Param * 10) + (New->Text[End++] - '0');
+		if (Param == 0x0 || Param > 0xFF) continue; // Not a valid parameter, so keep it as literal.
+
+		if (Idx > LiteralStart) New->Segments.push_back({ (uint16_t)LiteralStart, (uint16_t)(Idx - LiteralStart), 0x0 });
+		New->Segments.push_back({ (uint16_t)Idx, (uint16_t)(End - Idx), (uint8_t)Param }); // Keeps the '@N' text for missing arguments.
+
+		LiteralStart = End;
+		Idx = End - 1;
+	}
+
+	if (New->Text.size() > LiteralStart) New->Segments.push_back({ (uint16_t)LiteralStart, (uint16_t)(New->Text.size() - LiteralStart), 0x0 });
+	for (const StringTemplate::Segment &Seg : New->Segments) {
+		if (Seg.Param == 0x0) New->LiteralSize += Seg.Length;
+	}
+
+	/* If another thread was faster, use its template instead. */
+	if (!Cached.compare_exchange_strong(Template, New, std::memory_order_acq_rel, std::memory_order_acquire)) {
+		delete New;
+		return Template;
+	}
+
+	return New;
+};
+
+
+
+/*
+	Formats a template into Buffer, see Format in the header.
+
+	const std::string_view *Params: The parameters, Params[0] is '@1'.
+	const size_t ParamAmount: The amount of parameters.
+*/
+size_t TSGBAStringFetcher::FormatParams(const TSGBAStringFetcher::StringTemplate &Template, char *Buffer, const size_t BufferSize, const std::string_view *Params, const size_t ParamAmount) {
+	/* Calculate the size once, so everything can then be copied without any checks. */
+	size_t Size = Template.LiteralSize;
+	for (const StringTemplate::Segment &Seg : Template.Segments) {
+		if (Seg.Param != 0x0) Size += (Seg.Param <= ParamAmount ? Params[Seg.Param - 1].size() : Seg.Length);
+	}
+
+	if (!Buffer || Size >= BufferSize) return Size;
+
+	char *Pos = Buffer;
+	for (const StringTemplate::Segment &Seg : Template.Segments) {
+		if (Seg.Param != 0x0 && Seg.Param <= ParamAmount) {
+			memcpy(Pos, Params[Seg.Param - 1].data(), Params[Seg.Param - 1].size());
+			Pos += Params[Seg.Param - 1].size();
+
+		} else {
+			memcpy(Pos, Template.Text.data() + Seg.Offset, Seg.Length);
+			Pos += Seg.Length;
+		}
+	}
+
+	*Pos = '\0';
+	return Size;
+};
+
+
+
+/*
+	Fetches the still encoded bytes of a string from the ROM.
+
+	const uint16_t StringID: The ID of the string to fetch.
+	const Languages Language: The language to fetch.
+
+	Returns a std::string with the raw bytes of the wanted string, including the 0x0 terminator.
+*/
+std::string TSGBAStringFetcher::FetchRaw(const uint16_t StringID, const TSGBAStringFetcher::Languages Language, TSGBAStringFetcher::StringRange *Range) const {
+	std::string TempStr           =  "";
+	uint8_t     Counter           = 0x0;
+	uint16_t    Character         = 0x0;
+	uint32_t    ShiftVal          = 0x0;
+	uint32_t    ShiftAddr         = 0x0;
+	TSGBAStringFetcher::StringLocs Locs;
+	TSGBA_STAT(const auto Start = std::chrono::steady_clock::now(); uint64_t Bits = 0x0;)
+
+	/* Ensure the data are valid and the ID is in proper range before we do it. */
+	if (this->SupportedGame() && this->ROMData && this->ROMData.get() && StringID <= this->GetMaxStringID()) {
+		Locs = this->GetLocForGame(Language);
+
+		ShiftAddr = (Locs.Address1 + *reinterpret_cast<const uint32_t *>(this->ROMData.get() + (StringID * 0x4) + Locs.Address2));
+		ShiftVal = *reinterpret_cast<const uint32_t *>(this->ROMData.get() + ShiftAddr);
+		if (Range) Range->Start = ShiftAddr;
+		TSGBA_TRACE(this->TracePage(Language, (StringID * 0x4) + Locs.Address2); this->TracePage(Language, ShiftAddr);)
+
+		do {
+			Character = 0x100;
+
+			do {
+				TSGBA_TRACE(this->TracePage(Language, (Character * 0x4) + Locs.Address3 - (((ShiftVal >> Counter) % 0x2) == 0 ? 0x400 : 0x3FE));)
+				Character = *reinterpret_cast<const uint16_t *>(this->ROMData.get() + (Character * 0x4) + Locs.Address3 - (((ShiftVal >> Counter) % 0x2) == 0 ? 0x400 : 0x3FE));
+				Counter++;
+				TSGBA_STAT(Bits++;)
+
+				if (Counter == 0x8) {
+					Counter = 0x0;
+					ShiftAddr++;
+					ShiftVal = *reinterpret_cast<const uint32_t *>(this->ROMData.get() + ShiftAddr);
+					TSGBA_TRACE(this->TracePage(Language, ShiftAddr);)
+				}
+			} while (0xFF < Character);
+
+			TempStr.push_back((uint8_t)Character);
+		} while (Character != 0x0);
+
+		if (Range) Range->End = ShiftAddr + 0x3; // ShiftVal always reads 4 bytes.
+	}
+
+	TSGBA_STAT(
+		const uint64_t NS = ElapsedNS(Start);
+		this->Statistics.Fetches.fetch_add(1, std::memory_order_relaxed);
+		this->Statistics.BitsConsumed.fetch_add(Bits, std::memory_order_relaxed);
+		this->Statistics.BytesFetched.fetch_add(TempStr.size(), std::memory_order_relaxed);
+		this->Statistics.FetchTime.fetch_add(NS, std::memory_order_relaxed);
+		AddToHistogram(this->Statistics.FetchHistogram, NS);
+	)
+
+	return TempStr;
+};
+
+
+/*
+	Gets the BulkTable of a language, which gets built on the first call. Only the nodes which can be reached from the root get filled.
+
+	const Languages Language: The language to get the table of.
+
+	Returns nullptr if the tree doesn't look valid, FetchBulk uses FetchRaw then.
+*/
+const TSGBAStringFetcher::BulkTable *TSGBAStringFetcher::GetBulkTable(const TSGBAStringFetcher::Languages Language) const {
+	std::atomic<const BulkTable *> &Cached = this->BulkTables[this->LangIdx(Language)];
+	const BulkTable *Table = Cached.load(std::memory_order_acquire);
+	if (Table) return (Table == &MalformedTree ? nullptr : Table);
+
+	const uint8_t *Data = this->ROMData.get();
+	const StringLocs Locs = this->GetLocForGame(Language);
+	const auto Child = [&](const uint32_t Node, const uint32_t Bit) {
+		uint16_t Next = 0x0;
+		memcpy(&Next, Data + (Node * 0x4) + Locs.Address3 - 0x400 + (Bit * 0x2), 0x2);
+		return Next;
+	};
+
+	/* Find the nodes which can be reached, a tree of 256 characters only needs 255 of them. */
+	static constexpr uint32_t MaxNodes = 0x1000;
+	std::vector<bool> Reached(MaxNodes, false);
+	std::vector<uint32_t> Pending = { 0x100 };
+	uint32_t NodeAmount = 0x0;
+
+	while (!Pending.empty()) {
+		const uint32_t Node = Pending.back();
+		Pending.pop_back();
+
+		if (Node <= 0xFF) continue;
+		if (Node - 0x100 >= MaxNodes) {
+			Cached.compare_exchange_strong(Table, &MalformedTree, std::memory_order_acq_rel, std::memory_order_acquire);
+			return nullptr;
+		}
+		if (Reached[Node - 0x100]) continue;
+
+		Reached[Node - 0x100] = true;
+		NodeAmount = std::max(NodeAmount, Node - 0x100 + 1);
+		Pending.push_back(Child(Node, 0x0));
+		Pending.push_back(Child(Node, 0x1));
+	}
+
+	BulkTable *New = new BulkTable(NodeAmount * 0x10, 0x0);
+	for (uint32_t Node = 0x100; Node < 0x100 + NodeAmount; Node++) {
+		if (!Reached[Node - 0x100]) continue;
+
+		for (uint32_t Bits = 0x0; Bits < 0x10; Bits++) {
+			uint32_t Next = Node, Walked = 0x0;
+
+			do {
+				Next = Child(Next, (Bits >> Walked) & 0x1);
+				Walked++;
+			} while (Next > 0xFF && Walked < 0x4);
+
+			(*New)[((Node - 0x100) * 0x10) + Bits] = Next | (Walked << 16) | ((Next <= 0xFF ? 0x1 : 0x0) << 24);
+		}
+	}
+
+	/* If another thread was faster, use its table instead. */
+	if (!Cached.compare_exchange_strong(Table, New, std::memory_order_acq_rel, std::memory_order_acquire)) {
+		delete New;
+		return Table;
+	}
+
+	return New;
+};
+
+
+uint64_t TSGBAStringFetcher::FetchRawInterleaved(const uint16_t FirstID, const uint16_t Amount, const TSGBAStringFetcher::StringLocs &Locs, const TSGBAStringFetcher::BulkTable &Table, std::string *Results) const {
+	const uint8_t *Data = this->ROMData.get();
+	uint32_t BitPos[BulkLanes] = { 0x0 }, Node[BulkLanes] = { 0x0 }, Slot[BulkLanes] = { 0x0 }, Pos[BulkLanes] = { 0x0 };
+	char Buffer[BulkLanes][0x100] = { { '\0' } };
+	uint32_t Next = 0x0;
+	uint8_t Active = 0x0;
+	uint64_t Bits = 0x0;
+
+	/* Starts the next string on a lane, or lets the lane idle at ROM offset 0x0 if there are none left. */
+	const auto Refill = [&](const uint8_t Lane) {
+		Node[Lane] = 0x0;
+		Pos[Lane] = 0x0;
+
+		if (Next < Amount) {
+			uint32_t Offs = 0x0;
+			memcpy(&Offs, Data + ((FirstID + Next) * 0x4) + Locs.Address2, 0x4);
+
+			BitPos[Lane] = (Locs.Address1 + Offs) * 0x8;
+			Slot[Lane] = Next++;
+			Active++;
+
+		} else {
+			BitPos[Lane] = 0x0;
+			Slot[Lane] = UINT32_MAX;
+		}
+	};
+
+	for (uint8_t Lane = 0; Lane < BulkLanes; Lane++) Refill(Lane);
+
+	while (Active > 0x0) {
+		uint32_t Ended = 0x0;
+
+		/* Without branches on the characters, as they are not predictable. The character always gets written, but only kept when it is one. */
+		for (uint8_t Lane = 0; Lane < BulkLanes; Lane++) {
+			uint32_t Window = 0x0;
+			memcpy(&Window, Data + (BitPos[Lane] / 0x8), 0x4);
+
+			const uint32_t Entry = Table[(Node[Lane] * 0x10) + ((Window >> (BitPos[Lane] % 0x8)) & 0xF)];
+			const uint32_t Char = Entry & 0xFFFF, IsChar = (Entry >> 24) & (Slot[Lane] != UINT32_MAX); // Idle lanes never keep one.
+
+			BitPos[Lane] += (Entry >> 16) & 0xFF;
+			Buffer[Lane][Pos[Lane]] = (char)Char;
+			Pos[Lane] += IsChar;
+			Node[Lane] = ((Entry >> 24) ? 0x0 : Char - 0x100);
+			Ended |= ((IsChar & (Char == 0x0)) | (Pos[Lane] == sizeof(Buffer[Lane]))) << Lane;
+		}
+
+		while (Ended) {
+			const uint8_t Lane = __builtin_ctz(Ended);
+			Ended &= Ended - 1;
+
+			Results[Slot[Lane]].append(Buffer[Lane], Pos[Lane]);
+			const bool Done = (Buffer[Lane][Pos[Lane] - 1] == '\0');
+			Pos[Lane] = 0x0;
+
+			/* Otherwise only the buffer of the lane was full. */
+			if (Done) {
+				uint32_t Offs = 0x0;
+				memcpy(&Offs, Data + ((FirstID + Slot[Lane]) * 0x4) + Locs.Address2, 0x4);
+				Bits += BitPos[Lane] - ((Locs.Address1 + Offs) * 0x8);
+
+				Active--;
+				Refill(Lane);
+			}
+		}
+	}
+
+	return Bits;
+};
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	/* The lanes live in the 8 32-bit parts of AVX2 registers, only the characters and the ended strings go through memory. */
+	__attribute__((target("avx2")))
+	uint64_t TSGBAStringFetcher::FetchRawAVX2(const uint16_t FirstID, const uint16_t Amount, const TSGBAStringFetcher::StringLocs &Locs, const TSGBAStringFetcher::BulkTable &Table, std::string *Results) const {
+		const uint8_t *Data = this->ROMData.get();
+		const int *ROMBase = reinterpret_cast<const int *>(Data), *TableBase = reinterpret_cast<const int *>(Table.data());
+
+		alignas(0x20) int32_t BitPos[0x8] = { 0x0 }, Slot[0x8] = { 0x0 }, Chars[0x8] = { 0x0 };
+		uint32_t Pos[0x8] = { 0x0 }, Next = 0x0;
+		char Buffer[0x8][0x100] = { { '\0' } };
+
+		const auto Refill = [&](const uint8_t Lane) {
+			if (Next < Amount) {
+				uint32_t Offs = 0x0;
+				memcpy(&Offs, Data + ((FirstID + Next) * 0x4) + Locs.Address2, 0x4);
+
+				BitPos[Lane] = (Locs.Address1 + Offs) * 0x8;
+				Slot[Lane] = Next++;
+
+			} else {
+				Slot[Lane] = -1; // Turned off, the gathers skip it.
+			}
+		};
+
+		for (uint8_t Lane = 0; Lane < 0x8; Lane++) Refill(Lane);
+
+		const __m256i Zero = _mm256_setzero_si256(), Off = _mm256_set1_epi32(-1), Root = _mm256_set1_epi32(0x100);
+		const __m256i Seven = _mm256_set1_epi32(0x7), Low4 = _mm256_set1_epi32(0xF), Low8 = _mm256_set1_epi32(0xFF), Low16 = _mm256_set1_epi32(0xFFFF);
+		const __m256i NotWalked = _mm256_set1_epi32((int)0xFF00FFFF), EndEntry = _mm256_set1_epi32(0x1 << 24); // The 0x0 character.
+
+		__m256i VBitPos = _mm256_load_si256(reinterpret_cast<const __m256i *>(BitPos)), VNode = Zero, VBits = Zero;
+		__m256i VActive = _mm256_cmpgt_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(Slot)), Off);
+		int ActiveMask = _mm256_movemask_ps(_mm256_castsi256_ps(VActive));
+
+		while (ActiveMask) {
+			/* Entry = Table[(Node * 16) + ((u32 at BitPos / 8) >> (BitPos % 8)) & 0xF]. */
+			const __m256i Window = _mm256_mask_i32gather_epi32(Zero, ROMBase, _mm256_srli_epi32(VBitPos, 0x3), VActive, 0x1);
+			const __m256i Nibble = _mm256_and_si256(_mm256_srlv_epi32(Window, _mm256_and_si256(VBitPos, Seven)), Low4);
+			const __m256i Entry = _mm256_mask_i32gather_epi32(Zero, TableBase, _mm256_add_epi32(_mm256_slli_epi32(VNode, 0x4), Nibble), VActive, 0x4);
+
+			const __m256i Char = _mm256_and_si256(Entry, Low16), Walked = _mm256_and_si256(_mm256_srli_epi32(Entry, 16), Low8);
+			const __m256i IsChar = _mm256_cmpgt_epi32(_mm256_srli_epi32(Entry, 24), Zero);
+
+			VBitPos = _mm256_add_epi32(VBitPos, Walked);
+			VBits = _mm256_add_epi32(VBits, Walked);
+			VNode = _mm256_andnot_si256(IsChar, _mm256_sub_epi32(Char, Root));
+
+			/* Like FetchRawInterleaved, the character always gets written, but only kept when it is one. */
+			const int CharMask = _mm256_movemask_ps(_mm256_castsi256_ps(IsChar));
+			_mm256_store_si256(reinterpret_cast<__m256i *>(Chars), Char);
+
+			for (uint8_t Lane = 0; Lane < 0x8; Lane++) {
+				Buffer[Lane][Pos[Lane]] = (char)Chars[Lane];
+				Pos[Lane] += (CharMask >> Lane) & 0x1;
+			}
+
+			int EndMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(Entry, NotWalked), EndEntry), VActive)));
+			for (uint8_t Lane = 0; Lane < 0x8; Lane++) {
+				if (Pos[Lane] == sizeof(Buffer[Lane])) {
+					Results[Slot[Lane]].append(Buffer[Lane], Pos[Lane]);
+					Pos[Lane] = 0x0;
+				}
+			}
+
+			if (EndMask) {
+				_mm256_store_si256(reinterpret_cast<__m256i *>(BitPos), VBitPos);
+
+				/* The string of the lane ended, which is rare enough to go through memory for the next one. */
+				while (EndMask) {
+					const uint8_t Lane = __builtin_ctz(EndMask);
+					EndMask &= EndMask - 1;
+
+					Results[Slot[Lane]].append(Buffer[Lane], Pos[Lane]);
+					Pos[Lane] = 0x0;
+					Refill(Lane);
+				}
+
+				VBitPos = _mm256_load_si256(reinterpret_cast<const __m256i *>(BitPos));
+				VActive = _mm256_cmpgt_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(Slot)), Off);
+				ActiveMask = _mm256_movemask_ps(_mm256_castsi256_ps(VActive));
+			}
+		}
+
+		alignas(0x20) uint32_t LaneBits[0x8] = { 0x0 };
+		_mm256_store_si256(reinterpret_cast<__m256i *>(LaneBits), VBits);
+
+		uint64_t Bits = 0x0;
+		for (const uint32_t Walked : LaneBits) Bits += Walked;
+		return Bits;
+	};
+#endif
+
+
+
+/*
+	Compares all strings of this ROM against the strings of another ROM (or another language of the same ROM).
+
+	The other side gets fetched on a second thread while this side is being fetched, and the still encoded bytes
+	are compared first, so only the String IDs which actually differ get decoded and passed to the callback.
+	The callback gets called in String ID order while the comparison is still running.
+
+	const TSGBAStringFetcher &Other: The fetcher to compare against. May be this fetcher itself.
+	const Languages Language: The language of this side.
+	const Languages OtherLanguage: The language of the other side.
+	const DiffCallback &Callback: Gets called for each differing String ID.
+
+	Returns the amount of differing String IDs.
+*/
+size_t TSGBAStringFetcher::Diff(const TSGBAStringFetcher &Other, const TSGBAStringFetcher::Languages Language, const TSGBAStringFetcher::Languages OtherLanguage, const TSGBAStringFetcher::DiffCallback &Callback) const {
+	/* Both sides need to be the same game, otherwise the String IDs don't match anyways. */
+	if (!this->SupportedGame() || this->DetectedGame() != Other.DetectedGame()) return 0;
+
+	const uint16_t MaxID = this->GetMaxStringID();
+	std::vector<std::string> OtherRaw(MaxID + 1);
+	std::atomic<uint32_t> OtherDone = 0x0; // The amount of String IDs the other side already fetched.
+	size_t Differences = 0;
+
+	std::thread OtherThread([&]() {
+		for (uint32_t StringID = 0x0; StringID <= MaxID; StringID++) {
+			OtherRaw[StringID] = Other.FetchRaw(StringID, OtherLanguage);
+			OtherDone.store(StringID + 1, std::memory_order_release);
+		}
+	});
+
+	for (uint32_t StringID = 0x0; StringID <= MaxID; StringID++) {
+		const std::string Raw = this->FetchRaw(StringID, Language);
+		while (OtherDone.load(std::memory_order_acquire) <= StringID) std::this_thread::yield();
+
+		if (Raw != OtherRaw[StringID]) {
+			if (Callback) Callback(StringID, this->Decode(Raw), this->Decode(OtherRaw[StringID]));
+			Differences++;
+		}
+
+		OtherRaw[StringID].clear();
+		OtherRaw[StringID].shrink_to_fit();
+	}
+
+	OtherThread.join();
+	return Differences;
+};
+
+
+
+/*
+	Decodes the passed string with the encoding / decoding table to a new string and returns it.
+	Maybe a better way should be there? For now that way works prolly fine.
+
+	const std::string &StringToDecode: The string to decode.
+*/
+std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const {
+	std::string NewString = "";
+	this->Decode(StringToDecode, NewString);
+	return NewString;
+};
+
+
+/*
+	Decodes the passed string like the Decode above, but into Out instead of a new string.
+
+	std::string_view StringToDecode: The string to decode.
+	std::string &Out: Where the decoded string gets stored, its old content gets replaced.
+*/
+void TSGBAStringFetcher::Decode(std::string_view StringToDecode, std::string &Out) const {
+	Out.clear();
+	if (StringToDecode.empty()) return; // Do nothing as it's empty.
+
+	TSGBA_STAT(const auto Start = std::chrono::steady_clock::now();)
+
+	for (size_t CurIdx = 0; CurIdx < StringToDecode.size(); CurIdx++) {
+		const uint8_t CurChar = (uint8_t)StringToDecode[CurIdx];
+
+		/* 0x1 - 0x9: Invalid below range;        0xB - 0x1F: Invalid below range too;    0xBC+: Invalid above range. */
+		if ((CurChar >= 0x1 && CurChar <= 0x9) || (CurChar >= 0xB && CurChar <= 0x1F) || (CurChar >= 0xBC)) continue;
+		
+		/* 0x7B up to 0xBA are the sign / letter things which aren't like real ASCII. 0xBB seems to be literally blank or so and 0xBC+ is invalid. */
+		if (CurChar >= 0x7B && CurChar <= 0xBA) {
+			Out += (this->DecodingTable[CurChar - 0x7B]);
+
+		/* Otherwise seems to be normal ASCII or whatever it is and push it normally back. */
+		} else {
+			Out += StringToDecode[CurIdx];
+		}
+	}
+
+	TSGBA_STAT(
+		const uint64_t NS = ElapsedNS(Start);
+		this->Statistics.Decodes.fetch_add(1, std::memory_order_relaxed);
+		this->Statistics.BytesDecoded.fetch_add(Out.size(), std::memory_order_relaxed);
+		this->Statistics.DecodeTime.fetch_add(NS, std::memory_order_relaxed);
+		AddToHistogram(this->Statistics.DecodeHistogram, NS);
+	)
+};
+
+
+
+/*
+	Constructor for TSGBAStringWriter, which writes the header of the format.
+
+	FILE *Out: The file to write to.
+	const Formats Format: The format to write.
+	const size_t BufferSize: The size after which the buffer gets written to the file.
+*/
+TSGBAStringWriter::TSGBAStringWriter(FILE *Out, const TSGBAStringWriter::Formats Format, const size_t BufferSize)
+	: Out(Out), Format(Format), BufferSize(BufferSize) {
+	this->Buffer.reserve(BufferSize + 0x1000);
+	this->AppendHeader(this->Buffer, this->Format);
+};
+
+
+void TSGBAStringWriter::Write(const uint16_t StringID, const TSGBAStringFetcher::Languages Language, std::string_view Str, std::string_view Source) {
+	this->AppendRecord(this->Buffer, this->Format, StringID, Language, Str, Source);
+	if (this->Buffer.size() >= this->BufferSize) this->Flush();
+};
+
+
+/*
+	Writes the buffer to the file and empties it again, while keeping its capacity.
+
+	Returns false if any write so far failed, such as on a full disk. Once a write failed, nothing else gets written.
+*/
+bool TSGBAStringWriter::Flush() {
+	if (!this->Out) this->Failed = true;
+	else if (!this->Failed && !this->Buffer.empty()) this->Failed = (fwrite(this->Buffer.data(), 0x1, this->Buffer.size(), this->Out) != this->Buffer.size());
+
+	this->Buffer.clear();
+	return !this->Failed;
+};
+
+
+void TSGBAStringWriter::AppendHeader(std::string &Dest, const TSGBAStringWriter::Formats Format) {
+	switch(Format) {
+		case Formats::CSV:
+			Dest += "language,id,string\r\n";
+			break;
+
+		case Formats::PO:
+			Dest += "msgid \"\"\nmsgstr \"\"\n\"Content-Type: text/plain; charset=UTF-8\\n\"\n\n";
+			break;
+
+		case Formats::JSONLines:
+		default:
+			break;
+	}
+};
 
 
 /*
-	Constructor for TSGBAStringFetcher, which checks the passed ROM for validation and loads it into RAM.
+	Appends a single record.
 
-	const std::string &ROMPath: The path to the ROM to load.
+	JSON Lines: {"language":"english","id":26,"string":"..."}
+	CSV:        english,0x1A,"..."
+	PO:         msgctxt "english:0x1A", msgid with the english source and msgstr with the string.
 */
-TSGBAStringFetcher::TSGBAStringFetcher(const std::string &ROMPath) {
-	if (access(ROMPath.c_str(), F_OK) != 0) return;
+void TSGBAStringWriter::AppendRecord(std::string &Dest, const TSGBAStringWriter::Formats Format, const uint16_t StringID, const TSGBAStringFetcher::Languages Language, std::string_view Str, std::string_view Source) {
+	/* Fetched strings still contain the 0x0 terminator, which is not part of the text. */
+	while (!Str.empty() && Str.back() == '\0') Str.remove_suffix(1);
+	while (!Source.empty() && Source.back() == '\0') Source.remove_suffix(1);
+
+	const char *LangName = LanguageNames[(uint8_t)Language < TSGBAStringFetcher::LanguageAmount ? (uint8_t)Language : 0];
+	char ID[8] = { '\0' };
+	char *IDEnd = std::to_chars(ID, ID + sizeof(ID), StringID, (Format == Formats::JSONLines ? 10 : 16)).ptr;
+	for (char *Digit = ID; Digit < IDEnd; Digit++) *Digit = toupper(*Digit); // Hexadecimal IDs are uppercase everywhere else.
+
+	switch(Format) {
+		case Formats::JSONLines:
+			Dest += "{\"language\":\"";
+			Dest += LangName;
+			Dest += "\",\"id\":";
+			Dest.append(ID, IDEnd);
+			Dest += ",\"string\":\"";
+			AppendEscaped(Dest, Format, Str);
+			Dest += "\"}\n";
+			break;
+
+		case Formats::CSV:
+			Dest += LangName;
+			Dest += ",0x";
+			Dest.append(ID, IDEnd);
+			Dest += ",\"";
+			AppendEscaped(Dest, Format, Str);
+			Dest += "\"\r\n";
+			break;
+
+		case Formats::PO:
+			Dest += "msgctxt \"";
+			Dest += LangName;
+			Dest += ":0x";
+			Dest.append(ID, IDEnd);
+			Dest += "\"\nmsgid \"";
+			AppendEscaped(Dest, Format, Source);
+			Dest += "\"\nmsgstr \"";
+			AppendEscaped(Dest, Format, Str);
+			Dest += "\"\n\n";
+			break;
+	}
+};
 
-	FILE *In = fopen(ROMPath.c_str(), "rb");
 
-	if (In) {
-		fseek(In, 0, SEEK_END);
-		const uint32_t Size = ftell(In);
-		fseek(In, 0, SEEK_SET);
+/*
+	Appends Str escaped for the format to Dest.
+	Runs of characters that don't need escaping (which are most of them) get appended at once.
+*/
+void TSGBAStringWriter::AppendEscaped(std::string &Dest, const TSGBAStringWriter::Formats Format, std::string_view Str) {
+	static constexpr char Hex[] = "0123456789ABCDEF";
+	size_t RunStart = 0;
 
-		if (Size >= this->MinROMSize && Size <= this->MaxROMSize) {
-			/* Check for the Magic Byte at 0xB2 that it's 0x96. */
-			uint8_t MagicByte = 0x0;
-			fseek(In, 0xB2, SEEK_SET);
-			fread(&MagicByte, 0x1, 0x1, In);
-			fseek(In, 0, SEEK_SET);
+	for (size_t Idx = 0; Idx < Str.size(); Idx++) {
+		const uint8_t Char = (uint8_t)Str[Idx];
 
-			if (MagicByte == 0x96) {
-				uint8_t IDFromROM[4] = { '\0' };
-				fseek(In, 0xAC, SEEK_SET);
-				fread(&IDFromROM, 0x1, 0x4, In);
-				fseek(In, 0, SEEK_SET);
+		if (Format == Formats::CSV) {
+			if (Char != '"') continue; // CSV fields are always quoted, so only quotes need doubling.
 
-				for (uint8_t Idx = 0; Idx < 3; Idx++) {
-					/* Check the Title ID of the ROM. */
-					if (memcmp(&this->TIDs[Idx], &IDFromROM, 0x4) == 0) {
-						this->ActiveGame = (TSGBAStringFetcher::Games)Idx;
-						break;
-					}
-				}
+		} else if (Char >= 0x20 && Char != '"' && Char != '\\') {
+			continue;
+		}
 
-				if (this->SupportedGame()) {
-					this->ROMData = std::make_unique<uint8_t[]>(Size);
-					fread(this->ROMData.get(), 0x1, Size, In);
+		Dest.append(Str.data() + RunStart, Idx - RunStart);
+		RunStart = Idx + 1;
+
+		switch(Char) {
+			case '"':
+				Dest += (Format == Formats::CSV ? "\"\"" : "\\\"");
+				break;
+
+			case '\\':
+				Dest += "\\\\";
+				break;
+
+			case '\n':
+				Dest += "\\n";
+				break;
+
+			case '\t':
+				Dest += "\\t";
+				break;
+
+			default:
+				if (Format == Formats::JSONLines) {
+					const char Escape[6] = { '\\', 'u', '0', '0', Hex[Char >> 4], Hex[Char & 0xF] };
+					Dest.append(Escape, sizeof(Escape));
+
+				} else {
+					const char Escape[4] = { '\\', 'x', Hex[Char >> 4], Hex[Char & 0xF] };
+					Dest.append(Escape, sizeof(Escape));
 				}
+				break;
+		}
+	}
+
+	Dest.append(Str.data() + RunStart, Str.size() - RunStart);
+};
+
+
+
+bool TSGBAStringDumper::Dump(const int16_t Language) {
+	this->StageWaits = { };
+	this->Sources.clear();
+	this->Decoded = std::make_unique<Ring<DecodedBatch, RingSize>>();
+	this->Formatted = std::make_unique<Ring<FormattedBatch, RingSize>>();
+
+	std::thread Decoding(&TSGBAStringDumper::DecodeStage, this, Language);
+	std::thread Formatting(&TSGBAStringDumper::FormatStage, this);
+	const bool Written = this->WriteStage(); // The writing runs on the calling thread.
+
+	Decoding.join();
+	Formatting.join();
+	this->Decoded.reset();
+	this->Formatted.reset();
+	return Written;
+};
+
+
+/* Fetches the strings into batches, until all of them are in the ring and the empty end batch follows. */
+void TSGBAStringDumper::DecodeStage(const int16_t Language) {
+	const uint16_t MaxID = this->Fetcher.GetMaxStringID();
+
+	/* PO needs the english strings as the msgid. */
+	if (this->Format == TSGBAStringWriter::Formats::PO) {
+		this->Sources.resize(MaxID + 1);
+		this->Fetcher.FetchBulk(0x0, MaxID + 1, TSGBAStringFetcher::Languages::English, this->Sources.data());
+	}
+
+	for (uint8_t Lang = 0; Lang < TSGBAStringFetcher::LanguageAmount; Lang++) {
+		if (Language >= 0 && Lang != Language) continue;
+
+		for (uint32_t FirstID = 0x0; FirstID <= MaxID; FirstID += BatchSize) {
+			DecodedBatch &Batch = this->Decoded->Acquire(this->StageWaits.DecodeFull);
+			Batch.Language = (TSGBAStringFetcher::Languages)Lang;
+			Batch.FirstID = FirstID;
+			Batch.Amount = std::min<uint32_t>(BatchSize, MaxID + 1 - FirstID);
+
+			if (!this->Sources.empty() && Batch.Language == TSGBAStringFetcher::Languages::English) {
+				std::copy_n(this->Sources.begin() + FirstID, Batch.Amount, Batch.Strings.begin());
+			} else {
+				this->Fetcher.FetchBulk(FirstID, Batch.Amount, Batch.Language, Batch.Strings.data());
 			}
+
+			this->Decoded->Publish();
 		}
+	}
 
-		fclose(In);
+	this->Decoded->Acquire(this->StageWaits.DecodeFull).Amount = 0x0;
+	this->Decoded->Publish();
+};
+
+
+/* Turns the decoded batches into the text of the format, the buffers of the batches keep their capacity between uses. */
+void TSGBAStringDumper::FormatStage() {
+	bool First = true;
+
+	while (true) {
+		const DecodedBatch &Batch = this->Decoded->Peek(this->StageWaits.FormatEmpty);
+		FormattedBatch &Text = this->Formatted->Acquire(this->StageWaits.FormatFull);
+		Text.Text.clear();
+		Text.Last = (Batch.Amount == 0x0);
+
+		if (First) TSGBAStringWriter::AppendHeader(Text.Text, this->Format);
+		First = false;
+
+		for (uint16_t Idx = 0; Idx < Batch.Amount; Idx++) {
+			TSGBAStringWriter::AppendRecord(Text.Text, this->Format, Batch.FirstID + Idx, Batch.Language, Batch.Strings[Idx],
+				this->Sources.empty() ? "" : this->Sources[Batch.FirstID + Idx]);
+		}
+
+		this->Decoded->Release();
+		this->Formatted->Publish();
+		if (Text.Last) return;
+	}
+};
+
+
+/* Writes the formatted batches to the file. After a failed write the batches still get taken, so the other stages can finish. */
+bool TSGBAStringDumper::WriteStage() {
+	bool Written = true;
+
+	while (true) {
+		const FormattedBatch &Text = this->Formatted->Peek(this->StageWaits.WriteEmpty);
+		const bool Last = Text.Last;
+
+		if (Written && !Text.Text.empty()) Written = (fwrite(Text.Text.data(), 0x1, Text.Text.size(), this->Out) == Text.Text.size());
+
+		this->Formatted->Release();
+		if (Last) return Written;
 	}
 };
 
 
 
 /*
-	Fetches a string from the ROM.
+	Adds all strings of all languages of a ROM to the bank.
 
-	const uint16_t StringID: The ID of the string to fetch.
-	const Languages Language: The language to fetch.
+	const TSGBAStringFetcher &Fetcher: The fetcher of the ROM.
 
-	Returns a std::string with the wanted string.
+	Returns the index of the ROM for Get, or InvalidROM if the fetcher has no supported ROM loaded, which then doesn't get added.
 */
-std::string TSGBAStringFetcher::Fetch(const uint16_t StringID, const TSGBAStringFetcher::Languages Language) {
-	std::string TempStr           =  "";
-	uint8_t     Counter           = 0x0;
-	uint16_t    Character         = 0x0;
-	uint32_t    ShiftVal          = 0x0;
-	uint32_t    ShiftAddr         = 0x0;
-	TSGBAStringFetcher::StringLocs Locs;
+size_t TSGBAStringBank::AddROM(const TSGBAStringFetcher &Fetcher) {
+	if (!Fetcher.SupportedGame()) return InvalidROM;
 
-	/* Ensure the data are valid and the ID is in proper range before we do it. */
-	if (this->SupportedGame() && this->ROMData && this->ROMData.get() && StringID <= this->GetMaxStringID()) {
-		Locs = this->GetLocForGame(Language);
+	ROMSlots ROM;
+	ROM.MaxID = Fetcher.GetMaxStringID();
+	ROM.Slots.resize(TSGBAStringFetcher::LanguageAmount * (ROM.MaxID + 1));
 
-		ShiftAddr = (Locs.Address1 + *reinterpret_cast<uint32_t *>(this->ROMData.get() + (StringID * 0x4) + Locs.Address2));
-		ShiftVal = *reinterpret_cast<uint32_t *>(this->ROMData.get() + ShiftAddr);
+	std::vector<std::string> Strings(ROM.MaxID + 1);
+	for (uint8_t Lang = 0; Lang < TSGBAStringFetcher::LanguageAmount; Lang++) {
+		Fetcher.FetchBulk(0x0, ROM.MaxID + 1, (TSGBAStringFetcher::Languages)Lang, Strings.data());
 
-		do {
-			Character = 0x100;
+		for (uint32_t StringID = 0x0; StringID <= ROM.MaxID; StringID++) {
+			std::string &Str = Strings[StringID];
+			while (!Str.empty() && Str.back() == '\0') Str.pop_back(); // The 0x0 terminator is not part of the text.
 
-			do {
-				Character = *reinterpret_cast<uint16_t *>(this->ROMData.get() + (Character * 0x4) + Locs.Address3 - (((ShiftVal >> Counter) % 0x2) == 0 ? 0x400 : 0x3FE));
-				Counter++;
+			ROM.Slots[(Lang * (ROM.MaxID + 1)) + StringID] = this->Intern(Str);
+		}
+	}
 
-				if (Counter == 0x8) {
-					Counter = 0x0;
-					ShiftAddr++;
-					ShiftVal = *reinterpret_cast<uint32_t *>(this->ROMData.get() + ShiftAddr);
-				}
-			} while (0xFF < Character);
+	this->ROMs.push_back(std::move(ROM));
+	this->Pool.shrink_to_fit();
+	this->Entries.shrink_to_fit();
+	return this->ROMs.size() - 1;
+};
 
-			TempStr.push_back((uint8_t)Character);
-		} while (Character != 0x0);
+
+/* Frees the content lookup and all unused capacity, for when no more ROMs get added. Adding one afterwards still works, but builds the lookup again. */
+void TSGBAStringBank::ShrinkToFit() {
+	this->Lookup.clear();
+	this->Lookup.shrink_to_fit();
+	this->Pool.shrink_to_fit();
+	this->Entries.shrink_to_fit();
+	this->ROMs.shrink_to_fit();
+};
+
+
+/*
+	Gets a string of the bank. The returned std::string_view stays valid until the next AddROM.
+
+	const size_t ROMIdx: The index of the ROM, returned by AddROM.
+	const TSGBAStringFetcher::Languages Language: The language of the string.
+	const uint16_t StringID: The ID of the string.
+*/
+std::string_view TSGBAStringBank::Get(const size_t ROMIdx, const TSGBAStringFetcher::Languages Language, const uint16_t StringID) const {
+	if (ROMIdx >= this->ROMs.size() || (uint8_t)Language >= TSGBAStringFetcher::LanguageAmount || StringID > this->ROMs[ROMIdx].MaxID) return "";
+
+	const Entry &Str = this->Entries[this->ROMs[ROMIdx].Slots[((uint8_t)Language * (this->ROMs[ROMIdx].MaxID + 1)) + StringID]];
+	return std::string_view(this->Pool.data() + Str.Offset, Str.Length);
+};
+
+
+/*
+	Returns the index of Str in the pool and only adds it, if it's not in there yet.
+
+	std::string_view Str: The string to intern.
+*/
+uint32_t TSGBAStringBank::Intern(std::string_view Str) {
+	/* Keep at most 3 / 4 of the slots used, so the probing stays short. */
+	if ((this->Entries.size() + 1) * 4 > this->Lookup.size() * 3) this->BuildLookup(std::max<size_t>(0x400, std::bit_ceil((this->Entries.size() + 1) * 2)));
+
+	const size_t Mask = this->Lookup.size() - 1;
+	for (size_t Slot = std::hash<std::string_view>{}(Str) & Mask;; Slot = (Slot + 1) & Mask) {
+		if (this->Lookup[Slot] == 0x0) {
+			this->Entries.push_back({ (uint32_t)this->Pool.size(), (uint32_t)Str.size() });
+			this->Pool.insert(this->Pool.end(), Str.begin(), Str.end());
+			this->Lookup[Slot] = this->Entries.size();
+
+			return this->Entries.size() - 1;
+		}
+
+		const Entry &Existing = this->Entries[this->Lookup[Slot] - 1];
+		if (Existing.Length == Str.size() && std::string_view(this->Pool.data() + Existing.Offset, Existing.Length) == Str) return this->Lookup[Slot] - 1;
 	}
+};
+
+
+/*
+	Builds the lookup again with all strings of the pool, when it grows or after ShrinkToFit freed it.
+
+	const size_t SlotAmount: The amount of slots, needs to be a power of 2.
+*/
+void TSGBAStringBank::BuildLookup(const size_t SlotAmount) {
+	this->Lookup.assign(SlotAmount, 0x0);
+
+	for (uint32_t Idx = 0; Idx < this->Entries.size(); Idx++) {
+		const std::string_view Str(this->Pool.data() + this->Entries[Idx].Offset, this->Entries[Idx].Length);
 
-	return this->Decode(TempStr); // Return the decoded string.
+		size_t Slot = std::hash<std::string_view>{}(Str) & (SlotAmount - 1);
+		while (this->Lookup[Slot] != 0x0) Slot = (Slot + 1) & (SlotAmount - 1);
+		this->Lookup[Slot] = Idx + 1;
+	}
 };
 
 
 
 /*
-	Decodes the passed string with the encoding / decoding table to a new string and returns it.
-	Maybe a better way should be there? For now that way works prolly fine.
+	Constructor for TSGBAStringWatcher, which loads the ROM and decodes all strings for the first Snapshot.
 
-	const std::string &StringToDecode: The string to decode.
+	const std::string &ROMPath: The path to the ROM to watch.
 */
-std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const {
-	if (StringToDecode.empty()) return ""; // Do nothing as it's empty.
-	std::string NewString = "";
+TSGBAStringWatcher::TSGBAStringWatcher(const std::string &ROMPath) : ROMPath(ROMPath) {
+	this->Refresh();
+};
 
-	for (size_t CurIdx = 0; CurIdx < StringToDecode.size(); CurIdx++) {
-		const uint8_t CurChar = (uint8_t)StringToDecode[CurIdx];
 
-		/* 0x1 - 0x9: Invalid below range;        0xB - 0x1F: Invalid below range too;    0xBC+: Invalid above range. */
-		if ((CurChar >= 0x1 && CurChar <= 0x9) || (CurChar >= 0xB && CurChar <= 0x1F) || (CurChar >= 0xBC)) continue;
-		
-		/* 0x7B up to 0xBA are the sign / letter things which aren't like real ASCII. 0xBB seems to be literally blank or so and 0xBC+ is invalid. */
-		if (CurChar >= 0x7B && CurChar <= 0xBA) {
-			NewString += (this->DecodingTable[CurChar - 0x7B]);
+/*
+	Loads the ROM again and decodes all strings which are affected by a change since the last Refresh.
+	The new strings get published as a new Snapshot, unless nothing changed or the ROM isn't valid (for example while it's being written).
 
-		/* Otherwise seems to be normal ASCII or whatever it is and push it normally back. */
-		} else {
-			NewString += StringToDecode[CurIdx];
+	Returns the amount of strings that were decoded again.
+*/
+size_t TSGBAStringWatcher::Refresh() {
+	std::shared_ptr<const TSGBAStringFetcher> Fetcher = std::make_shared<const TSGBAStringFetcher>(this->ROMPath);
+	if (!Fetcher->SupportedGame()) return 0;
+
+	/* The last Snapshot keeps its fetcher and with that the previous ROM, which everything gets compared against. */
+	const std::shared_ptr<const Snapshot> Old = this->Current.load();
+	const bool Full = !Old || Old->Fetcher->DetectedGame() != Fetcher->DetectedGame() || Old->Fetcher->ROMSize != Fetcher->ROMSize;
+
+	/* If any of the bytes from Start to End (inclusive) differ from the previous ROM. */
+	auto RangeDirty = [&Fetcher, &Old](const uint32_t Start, const uint32_t End) {
+		return memcmp(Fetcher->ROMData.get() + Start, Old->Fetcher->ROMData.get() + Start, End - Start + 1) != 0;
+	};
+
+	std::shared_ptr<Snapshot> Snap = std::make_shared<Snapshot>();
+	Snap->Fetcher = Fetcher;
+	Snap->Generation = (Old ? Old->Generation + 1 : 0x0);
+	Snap->MaxID = Fetcher->GetMaxStringID();
+	Snap->Strings.resize(TSGBAStringFetcher::LanguageAmount * (Snap->MaxID + 1));
+
+	std::vector<TSGBAStringFetcher::StringRange> NewRanges(Snap->Strings.size());
+	size_t Redecoded = 0;
+	bool LangChanged = false;
+
+	for (uint8_t Lang = 0; Lang < TSGBAStringFetcher::LanguageAmount; Lang++) {
+		/* The tree is between Address3 and Address2 and the offset table after Address2, if anything there changed, all strings of the language are affected. */
+		const TSGBAStringFetcher::StringLocs Locs = Fetcher->GetLocForGame((TSGBAStringFetcher::Languages)Lang);
+		const bool LangDirty = Full || RangeDirty(Locs.Address1, Locs.Address2 + ((Snap->MaxID + 1) * 0x4) - 1);
+		LangChanged |= LangDirty;
+
+		for (uint32_t StringID = 0x0; StringID <= Snap->MaxID; StringID++) {
+			const size_t Idx = (Lang * (Snap->MaxID + 1)) + StringID;
+
+			if (!LangDirty && !RangeDirty(this->Ranges[Idx].Start, this->Ranges[Idx].End)) {
+				Snap->Strings[Idx] = Old->Strings[Idx];
+				NewRanges[Idx] = this->Ranges[Idx];
+				continue;
+			}
+
+			Snap->Strings[Idx] = Fetcher->Decode(Fetcher->FetchRaw(StringID, (TSGBAStringFetcher::Languages)Lang, &NewRanges[Idx]));
+			while (!Snap->Strings[Idx].empty() && Snap->Strings[Idx].back() == '\0') Snap->Strings[Idx].pop_back();
+			Redecoded++;
 		}
 	}
 
-	return NewString;
+	if (Redecoded == 0 && !LangChanged) return 0; // Only bytes which no string uses changed.
+
+	this->Ranges = std::move(NewRanges);
+	this->Current.store(Snap);
+
+	return Redecoded;
 };
 
 
+#ifdef __linux__
+	/*
+		Watches the ROM with inotify and calls Refresh whenever it got written or replaced, until Stop is set.
+
+		const std::function<...> &OnChange: Gets called with the new Snapshot and the amount of decoded strings after each change.
+		const std::atomic<bool> &Stop: Set it to true to stop watching (checked at least every 500 ms).
+	*/
+	void TSGBAStringWatcher::Watch(const std::function<void(const Snapshot &Snap, const size_t Redecoded)> &OnChange, const std::atomic<bool> &Stop) {
+		const int FD = inotify_init1(IN_CLOEXEC);
+		if (FD < 0) return;
+
+		/* Watch the directory, because patching tools often write a new file and rename it over the ROM. */
+		const std::filesystem::path Path(this->ROMPath);
+		const std::string Directory = Path.has_parent_path() ? Path.parent_path().string() : ".", Name = Path.filename().string();
+
+		if (inotify_add_watch(FD, Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+			close(FD);
+			return;
+		}
+
+		alignas(struct inotify_event) char Events[0x1000];
+		pollfd Poll = { FD, POLLIN, 0 };
+
+		while (!Stop.load()) {
+			if (poll(&Poll, 1, 500) <= 0) continue;
+
+			bool Changed = false;
+			const ssize_t Size = read(FD, Events, sizeof(Events));
+			for (ssize_t Offs = 0; Offs < Size; Offs += sizeof(struct inotify_event) + reinterpret_cast<struct inotify_event *>(Events + Offs)->len) {
+				const struct inotify_event *Event = reinterpret_cast<struct inotify_event *>(Events + Offs);
+				if (Event->len > 0 && Name == Event->name) Changed = true;
+			}
+
+			if (!Changed) continue;
+
+			/* Wait until the writes settle down, so a ROM that is written in multiple steps only gets refreshed once. */
+			while (poll(&Poll, 1, 200) > 0) {
+				if (read(FD, Events, sizeof(Events)) <= 0) break;
+			}
+
+			const size_t Redecoded = this->Refresh();
+			if (Redecoded > 0 && OnChange) OnChange(*this->GetSnapshot(), Redecoded);
+		}
+
+		close(FD);
+	};
+#endif
+
+
 
 /* Direct Use would include this int main. */
 #ifdef _DIRECT_USE
@@ -183,12 +1636,123 @@ std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const
 		return 0;
 	};
 
+	/* Prints a histogram of TSGBAStringFetcher::Stats, skipping the empty buckets. */
+	void PrintHistogram(const char *Name, const TSGBAStringFetcher::Stats::Histogram &Hist) {
+		uint64_t Max = 0x0;
+		for (const auto &Bucket : Hist) Max = std::max<uint64_t>(Max, Bucket.load());
+		if (Max == 0x0) return;
+
+		printf("%s:\n", Name);
+		for (uint8_t Idx = 0; Idx < TSGBAStringFetcher::Stats::HistogramBuckets; Idx++) {
+			const uint64_t Count = Hist[Idx].load();
+			if (Count == 0x0) continue;
+
+			printf("  < %12llu ns: %10llu %.*s\n", 1ULL << Idx, (unsigned long long)Count, (int)((Count * 40 + Max - 1) / Max),
+				"########################################");
+		}
+	};
+
+	/* Prints a summary of TSGBAStringFetcher::Stats. */
+	void PrintStats(const TSGBAStringFetcher::Stats &Stats) {
+		if (!TSGBAStringFetcher::StatsEnabled) {
+			printf("No stats available, compile with -D_STATS to get them.\n");
+			return;
+		}
+
+		const uint64_t Fetches = Stats.Fetches.load(), Decodes = Stats.Decodes.load();
+		printf(
+			"\nStats:\n" \
+			"ROM Open: %llu ns, Validate: %llu ns, Read: %llu ns.\n" \
+			"Fetch:  %llu calls, %llu bits consumed / tree nodes visited, %llu bytes, %llu ns total, %llu ns average.\n" \
+			"Decode: %llu calls, %llu bytes emitted, %llu ns total, %llu ns average.\n",
+			(unsigned long long)Stats.OpenTime, (unsigned long long)Stats.ValidateTime, (unsigned long long)Stats.ReadTime,
+			(unsigned long long)Fetches, (unsigned long long)Stats.BitsConsumed.load(), (unsigned long long)Stats.BytesFetched.load(),
+			(unsigned long long)Stats.FetchTime.load(), (unsigned long long)(Fetches ? Stats.FetchTime.load() / Fetches : 0),
+			(unsigned long long)Decodes, (unsigned long long)Stats.BytesDecoded.load(),
+			(unsigned long long)Stats.DecodeTime.load(), (unsigned long long)(Decodes ? Stats.DecodeTime.load() / Decodes : 0)
+		);
+
+		if (Stats.CacheHits.load() || Stats.CacheMisses.load()) {
+			printf("Template cache: %llu hits, %llu misses.\n", (unsigned long long)Stats.CacheHits.load(), (unsigned long long)Stats.CacheMisses.load());
+		}
+
+		PrintHistogram("Fetch histogram", Stats.FetchHistogram);
+		PrintHistogram("Decode histogram", Stats.DecodeHistogram);
+	};
+
+	/* Writes the page trace of the fetcher to a page profile, for the -trace parameter. */
+	void WriteTrace(const TSGBAStringFetcher &Fetcher, const std::string &TracePath) {
+		if (Fetcher.WritePageProfile(TracePath)) printf("The page profile has been written to %s.\n", TracePath.c_str());
+		else printf("The page profile could not be written.\n");
+	};
+
+	/*
+		Parses a language from the command line into Language.
+
+		const std::string &Lang: The language argument.
+		TSGBAStringFetcher::Languages &Language: Where to store the parsed language.
+
+		Returns true if the language is valid.
+	*/
+	bool ParseLanguage(const std::string &Lang, TSGBAStringFetcher::Languages &Language) {
+		if (Lang == "english" || Lang == "e") Language = TSGBAStringFetcher::Languages::English;
+		else if (Lang == "dutch" || Lang == "d") Language = TSGBAStringFetcher::Languages::Dutch;
+		else if (Lang == "french" || Lang == "f") Language = TSGBAStringFetcher::Languages::French;
+		else if (Lang == "german" || Lang == "g") Language = TSGBAStringFetcher::Languages::German;
+		else if (Lang == "italian" || Lang == "i") Language = TSGBAStringFetcher::Languages::Italian;
+		else if (Lang == "spanish" || Lang == "s") Language = TSGBAStringFetcher::Languages::Spanish;
+		else return false;
+
+		return true;
+	};
+
+	/*
+		Writes all strings of a TSGBAStringWatcher::Snapshot to the dump. It first gets written to a temporary file,
+		which only gets renamed over the dump once all of it got written, so the dump is never seen half written.
+		If writing fails, the temporary file gets removed and the old dump stays.
+
+		const TSGBAStringWatcher::Snapshot &Snap: The snapshot to write.
+		const std::string &DumpPath: The path of the dump.
+		const TSGBAStringWriter::Formats Format: The format of the dump.
+		const int16_t Language: The language to write, or -1 for all languages.
+	*/
+	bool WriteSnapshot(const TSGBAStringWatcher::Snapshot &Snap, const std::string &DumpPath, const TSGBAStringWriter::Formats Format, const int16_t Language) {
+		const std::string TempPath = DumpPath + ".tmp";
+		FILE *Out = fopen(TempPath.c_str(), "wb");
+		if (!Out) return false;
+		setvbuf(Out, nullptr, _IONBF, 0); // TSGBAStringWriter already buffers everything.
+
+		bool Written = false;
+		{
+			TSGBAStringWriter Writer(Out, Format);
+
+			for (uint8_t Lang = 0; Lang < TSGBAStringFetcher::LanguageAmount; Lang++) {
+				if (Language >= 0 && Lang != Language) continue;
+
+				for (uint32_t ID = 0x0; ID <= Snap.MaxID; ID++) {
+					Writer.Write(ID, (TSGBAStringFetcher::Languages)Lang, Snap.Get((TSGBAStringFetcher::Languages)Lang, ID), Snap.Get(TSGBAStringFetcher::Languages::English, ID));
+				}
+			}
+
+			Written = Writer.Flush();
+		}
+
+		if (fclose(Out) != 0) Written = false;
+		if (Written && rename(TempPath.c_str(), DumpPath.c_str()) == 0) return true;
+
+		remove(TempPath.c_str());
+		return false;
+	};
+
 	int main(int Argc, char *Argv[]) {
 		if (Argc > 1) {
 			bool Provided[3] = { false, false, false };
+			bool DiffMode = false, DiffLangProvided = false, ShowStats = false, WatchMode = false;
 
-			std::string ROMPath = "";
+			std::string ROMPath = "", DiffPath = "", DumpPath = "", TracePath = "", ProfilePath = "";
+			TSGBAStringWriter::Formats DumpFormat = TSGBAStringWriter::Formats::JSONLines;
 			TSGBAStringFetcher::Languages WantedLang = TSGBAStringFetcher::Languages::English;
+			TSGBAStringFetcher::Languages DiffLang = TSGBAStringFetcher::Languages::English;
 			uint16_t StringID = 0x0;
 
 			/* Go through all Arguments. */
@@ -197,7 +1761,7 @@ std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const
 
 				/* -i => Input. */
 				if (ARG == "-i" || ARG == "-input") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-i'.");
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-i'.");
 					ROMPath = Argv[Idx + 1];
 
 					Provided[0] = true;
@@ -206,43 +1770,87 @@ std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const
 
 				/* -l => Language. */
 				} else if (ARG == "-l" || ARG == "-language") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-l'.");
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-l'.");
+					if (!ParseLanguage(Argv[Idx + 1], WantedLang)) return AbortMain("No valid language has been provided with the parameter '-l'.");
 
-					const std::string Lang = Argv[Idx + 1];
+					Provided[1] = true;
+					Idx++;
+					continue;
 
-					if (Lang == "english" || Lang == "e") {
-						WantedLang = TSGBAStringFetcher::Languages::English;
+				/* -id => String ID in hexadecimal. */
+				} else if (ARG == "-id") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-id'.");
+					
+					StringID = strtoul(Argv[Idx + 1], nullptr, 16);
 
-					} else if (Lang == "dutch" || Lang == "d") {
-						WantedLang = TSGBAStringFetcher::Languages::Dutch;
+					Provided[2] = true;
+					Idx++;
+					continue;
 
-					} else if (Lang == "french" || Lang == "f") {
-						WantedLang = TSGBAStringFetcher::Languages::French;
+				/* -diff => Other ROM to compare against. */
+				} else if (ARG == "-diff") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-diff'.");
+					DiffPath = Argv[Idx + 1];
 
-					} else if (Lang == "german" || Lang == "g") {
-						WantedLang = TSGBAStringFetcher::Languages::German;
+					DiffMode = true;
+					Idx++;
+					continue;
 
-					} else if (Lang == "italian" || Lang == "i") {
-						WantedLang = TSGBAStringFetcher::Languages::Italian;
+				/* -dl => Language of the other side to compare against. */
+				} else if (ARG == "-dl" || ARG == "-difflanguage") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-dl'.");
+					if (!ParseLanguage(Argv[Idx + 1], DiffLang)) return AbortMain("No valid language has been provided with the parameter '-dl'.");
 
-					} else if (Lang == "spanish" || Lang == "s") {
-						WantedLang = TSGBAStringFetcher::Languages::Spanish;
+					DiffMode = true;
+					DiffLangProvided = true;
+					Idx++;
+					continue;
 
-					} else {
-						return AbortMain("No valid language has been provided with the parameter '-l'.");
-					}
+				/* -dump => Write all strings to a file. */
+				} else if (ARG == "-dump") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-dump'.");
+					DumpPath = Argv[Idx + 1];
 
-					Provided[1] = true;
 					Idx++;
 					continue;
 
-				/* -id => String ID in hexadecimal. */
-				} else if (ARG == "-id") {
-					if (Idx + 1 >= Argc) return AbortMain("No argument provided after '-id'.");
-					
-					StringID = strtoul(Argv[Idx + 1], nullptr, 16);
+				/* -format => Format of the dump. */
+				} else if (ARG == "-format") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-format'.");
+					const std::string Format = Argv[Idx + 1];
+
+					if (Format == "jsonl" || Format == "json") DumpFormat = TSGBAStringWriter::Formats::JSONLines;
+					else if (Format == "csv") DumpFormat = TSGBAStringWriter::Formats::CSV;
+					else if (Format == "po") DumpFormat = TSGBAStringWriter::Formats::PO;
+					else return AbortMain("No valid format has been provided with the parameter '-format'.");
 
-					Provided[2] = true;
+					Idx++;
+					continue;
+
+				/* -watch => Keep the dump up to date while the ROM changes. */
+				} else if (ARG == "-watch") {
+					WatchMode = true;
+					continue;
+
+				/* -stats => Print the stats at the end. */
+				} else if (ARG == "-stats") {
+					ShowStats = true;
+					continue;
+
+				/* -trace => Path to write the page profile to at the end. */
+				} else if (ARG == "-trace") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-trace'.");
+					if (!TSGBAStringFetcher::TraceEnabled) return AbortMain("'-trace' needs to be compiled with -D_PAGE_TRACE.");
+
+					TracePath = Argv[Idx + 1];
+					Idx++;
+					continue;
+
+				/* -profile => Page profile to read the ROM pages ahead with. */
+				} else if (ARG == "-profile") {
+					if (Idx + 1 >= (size_t)Argc) return AbortMain("No argument provided after '-profile'.");
+
+					ProfilePath = Argv[Idx + 1];
 					Idx++;
 					continue;
 
@@ -251,18 +1859,91 @@ std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const
 				}
 			}
 
-			/* Ensure all needed parameters have been provided to work on. */
-			for (int8_t Idx = 0; Idx < 3; Idx++) {
+			/* Ensure all needed parameters have been provided to work on. The String ID is not needed for a diff, and a dump only needs the ROM. */
+			for (int8_t Idx = 0; Idx < (!DumpPath.empty() ? 1 : (DiffMode ? 2 : 3)); Idx++) {
 				if (!Provided[Idx]) return AbortMain("Not all needed parameters have been provided.");
 			}
 
+			#ifdef __linux__
+				if (WatchMode) {
+					if (DumpPath.empty()) return AbortMain("'-watch' needs '-dump' to know where to write to.");
+
+					TSGBAStringWatcher Watcher(ROMPath);
+					const std::shared_ptr<const TSGBAStringWatcher::Snapshot> Snap = Watcher.GetSnapshot();
+					if (!Snap) return AbortMain("The provided ROM is either not supported, trimmed or doesn't exist.");
+
+					const int16_t Language = (Provided[1] ? (int16_t)WantedLang : -1);
+					if (!WriteSnapshot(*Snap, DumpPath, DumpFormat, Language)) return AbortMain("The dump file could not be written.");
+					printf("The strings have been dumped to %s, watching the ROM for changes now.\n", DumpPath.c_str());
+
+					const std::atomic<bool> Stop = false; // Runs until the tool gets closed.
+					Watcher.Watch([&](const TSGBAStringWatcher::Snapshot &Snap, const size_t Redecoded) {
+						if (WriteSnapshot(Snap, DumpPath, DumpFormat, Language)) printf("The ROM changed, %zu strings have been decoded again and the dump is updated.\n", Redecoded);
+						else printf("The ROM changed, but the dump file could not be written.\n");
+					}, Stop);
+
+					return 0;
+				}
+			#else
+				if (WatchMode) return AbortMain("'-watch' is only available on linux.");
+			#endif
+
 			/* The actual action. */
-			std::unique_ptr<TSGBAStringFetcher> Fetcher = std::make_unique<TSGBAStringFetcher>(ROMPath);
+			std::unique_ptr<TSGBAStringFetcher> Fetcher = std::make_unique<TSGBAStringFetcher>(ROMPath, ProfilePath);
 			if (Fetcher && Fetcher->SupportedGame()) {
+				if (!ProfilePath.empty()) printf("%u pages of the page profile are read ahead.\n", Fetcher->GetPrefetchedPages());
+
+				if (!DumpPath.empty()) {
+					FILE *Out = fopen(DumpPath.c_str(), "wb");
+					if (!Out) return AbortMain("The dump file could not be created.");
+					setvbuf(Out, nullptr, _IONBF, 0); // TSGBAStringDumper already writes whole batches.
+
+					TSGBAStringDumper Dumper(*Fetcher, Out, DumpFormat);
+					bool Written = Dumper.Dump(Provided[1] ? (int16_t)WantedLang : -1); // Without -l, all languages get dumped.
+
+					if (fclose(Out) != 0) Written = false;
+					if (!Written) return AbortMain("The dump file could not be written.");
+
+					printf("The strings have been dumped to %s.\n", DumpPath.c_str());
+					if (ShowStats) {
+						PrintStats(Fetcher->GetStats());
+
+						const TSGBAStringDumper::Waits &Waits = Dumper.GetWaits();
+						printf("Dump waits: decoding %llu (formatting was behind), formatting %llu / %llu (decoding / writing was behind), writing %llu (formatting was behind).\n",
+							(unsigned long long)Waits.DecodeFull, (unsigned long long)Waits.FormatEmpty, (unsigned long long)Waits.FormatFull, (unsigned long long)Waits.WriteEmpty);
+					}
+
+					if (!TracePath.empty()) WriteTrace(*Fetcher, TracePath);
+					return 0;
+				}
+
+				if (DiffMode) {
+					/* Without -diff, the other side is another language of the same ROM. */
+					std::unique_ptr<TSGBAStringFetcher> Other = nullptr;
+					if (!DiffPath.empty()) {
+						Other = std::make_unique<TSGBAStringFetcher>(DiffPath);
+						if (!Other->SupportedGame()) return AbortMain("The provided ROM to compare against is either not supported, trimmed or doesn't exist.");
+						if (Other->DetectedGame() != Fetcher->DetectedGame()) return AbortMain("Both ROMs need to be the same game.");
+					}
+
+					const size_t Differences = Fetcher->Diff(Other ? *Other : *Fetcher, WantedLang, DiffLangProvided ? DiffLang : WantedLang,
+						[](const uint16_t ID, const std::string &Left, const std::string &Right) {
+							printf("ID 0x%X:\n- %s\n+ %s\n", ID, Left.c_str(), Right.c_str());
+						}
+					);
+
+					printf("%zu String IDs differ.\n", Differences);
+					if (ShowStats) PrintStats(Fetcher->GetStats());
+					if (!TracePath.empty()) WriteTrace(*Fetcher, TracePath);
+					return 0;
+				}
+
 				if (StringID > Fetcher->GetMaxStringID()) return AbortMain("The String ID is too high.");
 
 				std::string Fetched = Fetcher->Fetch(StringID, WantedLang);
 				printf("Your wanted string is:\n%s\n", Fetched.c_str());
+				if (ShowStats) PrintStats(Fetcher->GetStats());
+				if (!TracePath.empty()) WriteTrace(*Fetcher, TracePath);
 
 			} else {
 				return AbortMain("The provided ROM is either not supported, trimmed or doesn't exist.");
@@ -271,12 +1952,23 @@ std::string TSGBAStringFetcher::Decode(const std::string &StringToDecode) const
 		/* No arguments provided => Show info. */
 		} else {
 			printf(
-				"TSGBAStringFetcher v0.3.0 by SuperSaiyajinStackZ, © 2021-2022.\n" \
+				"TSGBAStringFetcher v0.6.0 by SuperSaiyajinStackZ, © 2021-2022.\n" \
 				"Purpose: 'Extract' in-game strings from The Sims Game Boy Advance games.\n\n" \
-				"Usage: -i <PathToROM> -l <Language see below> -id <Hexadecimal ID of the string>\n\n" \
+				"Usage: -i <PathToROM> -l <Language see below> -id <Hexadecimal ID of the string>\n" \
+				"Diff:  -i <PathToROM> -l <Language see below> [-diff <PathToOtherROM>] [-dl <Language of the other side>]\n" \
+				"Dump:  -i <PathToROM> [-l <Language see below>] -dump <PathToOutput> [-format <jsonl, csv or po>] [-watch]\n" \
+				"All:   [-stats] [-trace <PathToProfile>] [-profile <PathToProfile>]\n\n" \
 				"Use -i or -input and then the path to the ROM to provide it as the ROM Source.\n" \
 				"Use -l or -language to provide the language you want the string to be.\n" \
-				"Use -id to provide the ID of the string in hexadecimal format you want to fetch.\n\n" \
+				"Use -id to provide the ID of the string in hexadecimal format you want to fetch.\n" \
+				"Use -diff to compare all strings against another ROM of the same game.\n" \
+				"Use -dl or -difflanguage to compare against another language (of the same ROM if -diff is not provided).\n" \
+				"Use -dump to write all strings of all languages (or only the one of -l) to a file.\n" \
+				"Use -format to provide the format of the dump: jsonl (default), csv or po.\n" \
+				"Use -watch to keep the dump up to date while the ROM changes (linux only).\n" \
+				"Use -stats to print the stats at the end (needs to be compiled with -D_STATS).\n" \
+				"Use -trace to write the ROM pages that got read to a page profile at the end (needs to be compiled with -D_PAGE_TRACE).\n" \
+				"Use -profile to map the ROM and only read the pages of a page profile ahead, instead of reading all of it (not on Windows, the ROM file must not change while it runs).\n\n" \
 				"Valid Languages:\nenglish or e\ndutch or d\nfrench or f\ngerman or g\nitalian or i\nspanish or s\n"
 			);
 		}
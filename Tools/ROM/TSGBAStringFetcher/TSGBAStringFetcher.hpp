@@ -27,10 +27,32 @@
 #ifndef _TSGBA_STRING_FETCHER_HPP
 #define _TSGBA_STRING_FETCHER_HPP
 
+#include <array> // std::array for the histograms of TSGBAStringFetcher::Stats and the batches of TSGBAStringDumper.
+#include <atomic> // std::atomic for the counters of TSGBAStringFetcher::Stats and the rings of TSGBAStringDumper.
+#include <cstdint> // SIZE_MAX for TSGBAStringBank::InvalidROM.
+#include <cstring> // memcmp to compare the ROM's TID.
+#include <functional> // std::function for the TSGBAStringFetcher::Diff and TSGBAStringWatcher::Watch callbacks.
+#include <future> // std::future for TSGBAStringFetcher::FetchAsync.
 #include <memory> // std::unique_ptr because i like those instead of raw pointers.
 #include <string> // Default include, it's always in my projects.
+#include <string_view> // std::string_view for the TSGBAStringWriter escaping.
+#include <vector> // std::vector for the String IDs and results of TSGBAStringFetcher::FetchAsync.
 
 
+/* Compile with -D_STATS to fill TSGBAStringFetcher::Stats, without it all the counting is removed at compile time. */
+#ifdef _STATS
+	#define TSGBA_STAT(...) __VA_ARGS__
+#else
+	#define TSGBA_STAT(...)
+#endif
+
+/* Compile with -D_PAGE_TRACE to record which pages of the ROM each language reads, see TSGBAStringFetcher::WritePageProfile. */
+#ifdef _PAGE_TRACE
+	#define TSGBA_TRACE(...) __VA_ARGS__
+#else
+	#define TSGBA_TRACE(...)
+#endif
+
 class TSGBAStringFetcher {
 public:
 	/* All available Languages can be found on this enum class. */
@@ -38,11 +60,87 @@ public:
 	enum class Games : uint8_t { BustinOut = 0, Urbz = 1, Sims2 = 2, Invalid = 3 };
 	static constexpr uint8_t LanguageAmount = 0x6;
 
-	TSGBAStringFetcher(const std::string &ROMPath);
-	std::string Fetch(const uint16_t StringID, const Languages Language = Languages::English);
+	/*
+		Counters and timers of the fetcher, which only get filled when compiled with -D_STATS.
+		All times are in nanoseconds. Histogram bucket N counts the calls which took less than 2^N nanoseconds.
+		Each bit read from the ROM visits exactly one tree node, so BitsConsumed is also the amount of visited nodes.
+	*/
+	struct Stats {
+		static constexpr uint8_t HistogramBuckets = 0x20;
+		using Histogram = std::array<std::atomic<uint64_t>, HistogramBuckets>;
+
+		/* ROM Loading, filled by the constructor. */
+		uint64_t OpenTime = 0x0, ValidateTime = 0x0, ReadTime = 0x0;
+
+		/* Fetch (reading the encoded bytes from the ROM). */
+		std::atomic<uint64_t> Fetches = 0x0, BitsConsumed = 0x0, BytesFetched = 0x0, FetchTime = 0x0;
+		Histogram FetchHistogram;
+
+		/* Decode (converting the encoded bytes to the final string). */
+		std::atomic<uint64_t> Decodes = 0x0, BytesDecoded = 0x0, DecodeTime = 0x0;
+		Histogram DecodeHistogram;
+
+		/* The template cache of FetchTemplate. */
+		std::atomic<uint64_t> CacheHits = 0x0, CacheMisses = 0x0;
+	};
+	static constexpr bool StatsEnabled = TSGBA_STAT(true ||) false;
+	static constexpr bool TraceEnabled = TSGBA_TRACE(true ||) false;
+	static constexpr uint32_t PageSize = 0x1000; // The pages of the page profiles.
+
+	/*
+		A string split into its literal parts and its formatting parameters, such as '@1' for parameter 1.
+		Get it through FetchTemplate and fill in the parameters with Format.
+	*/
+	struct StringTemplate {
+		struct Segment {
+			uint16_t Offset = 0x0; // The start of the literal part in Text.
+			uint16_t Length = 0x0; // The length of the literal part in Text.
+			uint8_t Param = 0x0; // 0 for a literal part, otherwise the number of the parameter.
+		};
+
+		std::string Text = ""; // The decoded string.
+		std::vector<Segment> Segments = { };
+		size_t LiteralSize = 0x0; // The size of all literal parts together.
+	};
+
+	/* Gets called by Diff for each String ID that differs, with the decoded strings of both sides. */
+	using DiffCallback = std::function<void(const uint16_t StringID, const std::string &Left, const std::string &Right)>;
+
+	TSGBAStringFetcher(const std::string &ROMPath, const std::string &ProfilePath = "");
+	~TSGBAStringFetcher();
+
+	/*
+		The ROM data never changes after the constructor, so all const functions (such as Fetch and Diff) are re-entrant.
+		One fetcher can be shared between as many threads as wanted without any locking.
+		With a page profile, the ROM is mapped instead of read, so this only holds while the ROM file stays unchanged, see the constructor.
+	*/
+	std::string Fetch(const uint16_t StringID, const Languages Language = Languages::English) const;
+	void FetchBulk(const uint16_t FirstID, const uint16_t Amount, const Languages Language, std::string *Results) const;
+	std::future<std::vector<std::string>> FetchAsync(std::vector<uint16_t> StringIDs, const Languages Language = Languages::English) const;
+	const StringTemplate *FetchTemplate(const uint16_t StringID, const Languages Language = Languages::English) const;
+
+	/*
+		Formats a template into Buffer, with Args as the parameters ('@1' is the first one). Parameters without an argument stay as they are.
+		Like snprintf, this returns the size the formatted string needs (without the null terminator), and only writes if it fits into the buffer.
+
+		const StringTemplate &Template: The template to format.
+		char *Buffer: The buffer to format into.
+		const size_t BufferSize: The size of the buffer.
+		const Args &...Arguments: The parameters, anything that converts to a std::string_view.
+	*/
+	template <typename... Args>
+	static size_t Format(const StringTemplate &Template, char *Buffer, const size_t BufferSize, const Args &...Arguments) {
+		const std::string_view Params[] = { std::string_view(Arguments)..., "" };
+		return FormatParams(Template, Buffer, BufferSize, Params, sizeof...(Arguments));
+	};
+	static size_t FormatParams(const StringTemplate &Template, char *Buffer, const size_t BufferSize, const std::string_view *Params, const size_t ParamAmount);
+	size_t Diff(const TSGBAStringFetcher &Other, const Languages Language, const Languages OtherLanguage, const DiffCallback &Callback) const;
 
 	Games DetectedGame() const { return this->ActiveGame; };
 	bool SupportedGame() const { return this->ActiveGame != Games::Invalid; };
+	const Stats &GetStats() const { return this->Statistics; };
+	bool WritePageProfile(const std::string &ProfilePath) const;
+	uint32_t GetPrefetchedPages() const { return this->PrefetchedPages; };
 	uint16_t GetMaxStringID() const {
 		switch(this->ActiveGame) {
 			case Games::BustinOut:
@@ -60,8 +158,41 @@ public:
 		}
 	};
 private:
+	friend class TSGBAStringWatcher; // Needs the ROM and the ranges of the strings to find out what changed.
+
 	Games ActiveGame = Games::Invalid;
-	std::unique_ptr<uint8_t[]> ROMData = nullptr;
+	/* Frees the ROM, which is either read into RAM (Mapped is 0) or mapped because of a page profile (Mapped is the size). */
+	struct ROMRelease {
+		size_t Mapped; // Size of the mapping, 0x0 if the ROM was read into a new[] buffer.
+		ROMRelease() : Mapped(0x0) { };
+		ROMRelease(size_t Mapped) : Mapped(Mapped) { };
+		void operator()(const uint8_t *Data) const;
+	};
+
+	std::unique_ptr<const uint8_t[], ROMRelease> ROMData;
+	uint32_t ROMSize = 0x0;
+	uint32_t PrefetchedPages = 0x0;
+	mutable Stats Statistics; // Mutable, because the const fetching functions count into it too.
+
+	/* The background thread and queue of FetchAsync, see TSGBAStringFetcher.cpp. */
+	struct AsyncExecutor;
+	std::unique_ptr<AsyncExecutor> Executor;
+
+	/*
+		The template cache of FetchTemplate with one slot per language and String ID.
+		Reading it is lock-free, a missing template gets parsed and then put in with a compare exchange.
+	*/
+	std::unique_ptr<std::atomic<const StringTemplate *>[]> Templates = nullptr;
+
+	/*
+		The tree of a language for FetchBulk, which walks 4 bits at once. The entry at ((Node - 0x100) * 0x10) + the next 4 bits
+		is where walking those bits from Node ends: the character or node in bits 0 - 15, the amount of bits walked in bits 16 - 23
+		and bits 24 - 31 are set if it ended at a character. It gets built once per language and kept, like the templates.
+	*/
+	using BulkTable = std::vector<uint32_t>;
+	mutable std::array<std::atomic<const BulkTable *>, LanguageAmount> BulkTables = { };
+	static inline const BulkTable MalformedTree = { }; // Cached instead of a table if the tree of a language is malformed, so it only gets walked once.
+
 	static constexpr uint8_t TIDs[3][4] = { 
 		{ 0x41, 0x53, 0x49, 0x45 }, // The Sims Bustin' Out.
 		{ 0x42, 0x4F, 0x43, 0x45 }, // The Urbz - Sims in the City.
@@ -112,6 +243,40 @@ private:
 		{ 0x01A697C0, 0x01A69978, 0x01A697C4 }  // Spanish.
 	};
 
+	/* Returns the game of the passed 4 byte Title ID, or Games::Invalid if it's not supported. */
+	Games GameFromTID(const uint8_t *TID) const {
+		for (uint8_t Idx = 0; Idx < 3; Idx++) {
+			if (memcmp(&this->TIDs[Idx], TID, 0x4) == 0) return (Games)Idx;
+		}
+
+		return Games::Invalid;
+	};
+
+	/*
+		Loads the ROM from a .gz or .zip archive by inflating it straight into the ROM buffer, see TSGBAStringFetcher.cpp.
+		Only available when compiled with -D_ARCHIVE_SUPPORT (and linked with zlib through -lz).
+	*/
+	#ifdef _ARCHIVE_SUPPORT
+		void LoadArchive(FILE *In, const bool IsZip);
+	#endif
+
+	void FinishLoad(const uint32_t Size);
+
+	/* Maps the ROM and reads the pages of the page profile ahead, see TSGBAStringFetcher.cpp. */
+	#if defined(__unix__) || defined(__APPLE__)
+		void MapROM(FILE *In, const uint32_t Size, const std::string &ProfilePath);
+	#endif
+
+	/*
+		The page trace of WritePageProfile, at (Language * page amount) + page: how often the page got read
+		and the order in which the pages got read first, 0 for pages which never got read.
+	*/
+	#ifdef _PAGE_TRACE
+		std::unique_ptr<std::atomic<uint32_t>[]> PageReads = nullptr, PageOrder = nullptr;
+		mutable std::atomic<uint32_t> PagesSeen = 0x0;
+		void TracePage(const Languages Language, const uint32_t Offset) const;
+	#endif
+
 	uint8_t LangIdx(const Languages Language) const {
 		switch(Language) {
 			case Languages::English:
@@ -158,6 +323,40 @@ private:
 		"ò", "ó", "ô", "õ", "ö", "ø", "ù", "ú", "û", "ü", "º", "ª", "…", "™", "", "®"
 	};
 
+	/* The ROM bytes the bitstream of a string was read from, Start up to and including End. */
+	struct StringRange {
+		uint32_t Start = 0x0;
+		uint32_t End = 0x0;
+	};
+
+	/*
+		Fetches the still encoded bytes of a string from the ROM, without running them through Decode.
+
+		const uint16_t StringID: The ID of the string to fetch.
+		const Languages Language: The language to fetch.
+		StringRange *Range: If not nullptr, the bytes the bitstream was read from get stored in there.
+	*/
+	std::string FetchRaw(const uint16_t StringID, const Languages Language, StringRange *Range = nullptr) const;
+
+	const BulkTable *GetBulkTable(const Languages Language) const;
+
+	/*
+		The same as FetchRaw for many strings at once, used by FetchBulk. The bitstreams of multiple strings get walked in lockstep
+		with the BulkTable, so the tree lookups of the strings don't wait on each other. FetchRawAVX2 does 8 strings with gathers,
+		FetchRawInterleaved does BulkLanes strings in plain C++ for every CPU. Both return the amount of bits consumed.
+
+		const uint16_t FirstID: The ID of the first string to fetch.
+		const uint16_t Amount: The amount of strings to fetch, which all need to be valid IDs.
+		const StringLocs &Locs: The locations of the language to fetch.
+		const BulkTable &Table: The table of the language to fetch.
+		std::string *Results: Where the still encoded bytes of the strings get appended to.
+	*/
+	static constexpr uint8_t BulkLanes = 0x4;
+	uint64_t FetchRawInterleaved(const uint16_t FirstID, const uint16_t Amount, const StringLocs &Locs, const BulkTable &Table, std::string *Results) const;
+	#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+		uint64_t FetchRawAVX2(const uint16_t FirstID, const uint16_t Amount, const StringLocs &Locs, const BulkTable &Table, std::string *Results) const;
+	#endif
+
 	/*
 		Decodes the passed string with the table above to a new string and returns it.
 		Maybe a better way should be there? For now that way works prolly fine.
@@ -165,6 +364,230 @@ private:
 		const std::string &StringToDecode: The string to decode.
 	*/
 	std::string Decode(const std::string &StringToDecode) const;
+	void Decode(std::string_view StringToDecode, std::string &Out) const; // The same, but into Out, which keeps its capacity.
+};
+
+
+/*
+	Buffered writer to dump fetched strings as JSON Lines, CSV or gettext PO.
+
+	All records get escaped and formatted into one large buffer, which is reused and only written out with a single fwrite once it's full,
+	so dumping doesn't do a syscall or an allocation per record.
+*/
+class TSGBAStringWriter {
+public:
+	enum class Formats : uint8_t { JSONLines = 0, CSV = 1, PO = 2 };
+	static constexpr const char *LanguageNames[TSGBAStringFetcher::LanguageAmount] = { "english", "dutch", "french", "german", "italian", "spanish" };
+
+	TSGBAStringWriter(FILE *Out, const Formats Format, const size_t BufferSize = 0x100000);
+	~TSGBAStringWriter() { this->Flush(); };
+
+	/*
+		Writes a string record.
+
+		const uint16_t StringID: The ID of the string.
+		const TSGBAStringFetcher::Languages Language: The language of the string.
+		std::string_view Str: The fetched string.
+		std::string_view Source: The english string for the msgid of PO, ignored for the other formats.
+	*/
+	void Write(const uint16_t StringID, const TSGBAStringFetcher::Languages Language, std::string_view Str, std::string_view Source = "");
+	bool Flush();
+
+	/* Appends the header (CSV column names or the PO header entry) and a single record of the format to Dest. */
+	static void AppendHeader(std::string &Dest, const Formats Format);
+	static void AppendRecord(std::string &Dest, const Formats Format, const uint16_t StringID, const TSGBAStringFetcher::Languages Language, std::string_view Str, std::string_view Source);
+private:
+	FILE *Out = nullptr;
+	Formats Format = Formats::JSONLines;
+	size_t BufferSize = 0x0;
+	std::string Buffer = "";
+	bool Failed = false; // Sticky, so a failed write can't be missed by only checking the last Flush.
+
+	static void AppendEscaped(std::string &Dest, const Formats Format, std::string_view Str);
+};
+
+
+/*
+	Dumps all strings of a ROM through a pipeline of three stages, each on its own thread: decoding, formatting and writing.
+
+	The stages are connected by bounded single producer, single consumer rings of batches. The batches get allocated once and
+	are reused, so a stage that is ahead waits for a free batch of the next stage instead of allocating more, and the whole dump
+	runs as fast as the slowest stage.
+*/
+class TSGBAStringDumper {
+public:
+	static constexpr size_t BatchSize = 0x100; // Strings per batch.
+	static constexpr size_t RingSize = 0x8; // Batches per ring, needs to be a power of 2.
+
+	/* How often a stage had to wait for one of its neighbours, which shows the slowest stage. */
+	struct Waits {
+		uint64_t DecodeFull = 0x0; // Decoding waited for the formatting to free a batch.
+		uint64_t FormatEmpty = 0x0; // Formatting waited for the decoding.
+		uint64_t FormatFull = 0x0; // Formatting waited for the writing to free a batch.
+		uint64_t WriteEmpty = 0x0; // Writing waited for the formatting.
+	};
+
+	TSGBAStringDumper(const TSGBAStringFetcher &Fetcher, FILE *Out, const TSGBAStringWriter::Formats Format)
+		: Fetcher(Fetcher), Out(Out), Format(Format) { };
+
+	/*
+		Dumps the strings and returns true if everything got written.
+
+		const int16_t Language: The language to dump, or -1 for all languages.
+	*/
+	bool Dump(const int16_t Language = -1);
+	const Waits &GetWaits() const { return this->StageWaits; };
+private:
+	/*
+		A bounded ring for one producer and one consumer thread. The producer fills the slot of Acquire and hands it over with
+		Publish, the consumer handles the slot of Peek and hands it back with Release. Both wait while the ring is full or empty.
+	*/
+	template <typename T, size_t Size>
+	class Ring {
+	public:
+		T &Acquire(uint64_t &Waits) {
+			const size_t Pos = this->Head.load(std::memory_order_relaxed);
+			this->WaitWhile(this->Tail, Pos - Size, Waits);
+			return this->Slots[Pos & (Size - 1)];
+		};
+
+		void Publish() {
+			this->Head.store(this->Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			this->Head.notify_one();
+		};
+
+		T &Peek(uint64_t &Waits) {
+			const size_t Pos = this->Tail.load(std::memory_order_relaxed);
+			this->WaitWhile(this->Head, Pos, Waits);
+			return this->Slots[Pos & (Size - 1)];
+		};
+
+		void Release() {
+			this->Tail.store(this->Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			this->Tail.notify_one();
+		};
+	private:
+		std::array<T, Size> Slots = { };
+		alignas(0x40) std::atomic<size_t> Head = 0x0; // Next slot the producer fills.
+		alignas(0x40) std::atomic<size_t> Tail = 0x0; // Next slot the consumer handles.
+
+		/* Spins shortly and then sleeps while Index still has the value Blocked. */
+		static void WaitWhile(const std::atomic<size_t> &Index, const size_t Blocked, uint64_t &Waits) {
+			if (Index.load(std::memory_order_acquire) != Blocked) return;
+			Waits++;
+
+			for (uint8_t Spin = 0; Spin < 0x40; Spin++) {
+				if (Index.load(std::memory_order_acquire) != Blocked) return;
+			}
+
+			while (Index.load(std::memory_order_acquire) == Blocked) Index.wait(Blocked, std::memory_order_acquire);
+		};
+	};
+
+	struct DecodedBatch {
+		TSGBAStringFetcher::Languages Language = TSGBAStringFetcher::Languages::English;
+		uint16_t FirstID = 0x0;
+		uint16_t Amount = 0x0; // 0 marks the end of the dump.
+		std::array<std::string, BatchSize> Strings = { };
+	};
+
+	struct FormattedBatch {
+		bool Last = false;
+		std::string Text = "";
+	};
+
+	const TSGBAStringFetcher &Fetcher;
+	FILE *Out = nullptr;
+	TSGBAStringWriter::Formats Format = TSGBAStringWriter::Formats::JSONLines;
+	Waits StageWaits = { };
+
+	std::vector<std::string> Sources = { }; // The english strings for PO, filled by the decoding before its first batch.
+	std::unique_ptr<Ring<DecodedBatch, RingSize>> Decoded = nullptr;
+	std::unique_ptr<Ring<FormattedBatch, RingSize>> Formatted = nullptr;
+
+	void DecodeStage(const int16_t Language);
+	void FormatStage();
+	bool WriteStage();
+};
+
+
+/*
+	Holds all strings of all languages of one or more ROMs, for bulk extraction.
+
+	Many strings are the same in multiple languages (names, numbers, symbols) or ROM revisions, so every string
+	is interned through a pool by its content and each language / String ID only stores the index of it in the pool.
+*/
+class TSGBAStringBank {
+public:
+	static constexpr size_t InvalidROM = SIZE_MAX; // Returned by AddROM for a fetcher without a supported ROM.
+
+	size_t AddROM(const TSGBAStringFetcher &Fetcher);
+	std::string_view Get(const size_t ROMIdx, const TSGBAStringFetcher::Languages Language, const uint16_t StringID) const;
+
+	void ShrinkToFit();
+
+	size_t ROMAmount() const { return this->ROMs.size(); };
+	size_t UniqueStrings() const { return this->Entries.size(); };
+	size_t PoolSize() const { return this->Pool.size(); };
+private:
+	/* The pool index of each language and String ID of a ROM, at (Language * (MaxID + 1)) + StringID. */
+	struct ROMSlots {
+		uint16_t MaxID = 0x0;
+		std::vector<uint32_t> Slots = { };
+	};
+
+	/* A string in the pool. */
+	struct Entry {
+		uint32_t Offset = 0x0;
+		uint32_t Length = 0x0;
+	};
+
+	std::vector<ROMSlots> ROMs = { };
+	std::vector<char> Pool = { }; // All unique strings after each other.
+	std::vector<Entry> Entries = { };
+
+	/*
+		Open addressing table to find the strings of the pool by their content, with Entry index + 1 per slot and 0 for a free slot.
+		It's only needed while adding ROMs, so ShrinkToFit frees it and the next AddROM builds it again.
+	*/
+	std::vector<uint32_t> Lookup = { };
+
+	uint32_t Intern(std::string_view Str);
+	void BuildLookup(const size_t SlotAmount);
+};
+
+
+/*
+	Keeps the decoded strings of a ROM up to date while the ROM gets patched, for the -watch parameter.
+
+	On a change, the bytes of each string are compared with the ROM of the last Snapshot and only the strings whose bytes changed
+	get decoded again, or all strings of a language if its tree or offset table changed. The result gets published as a new Snapshot at once,
+	so readers always get either all old or all new strings and never a mix. Refresh and Watch are meant to be used from one thread.
+*/
+class TSGBAStringWatcher {
+public:
+	struct Snapshot {
+		std::shared_ptr<const TSGBAStringFetcher> Fetcher = nullptr;
+		uint64_t Generation = 0x0; // Goes up with each change.
+		uint16_t MaxID = 0x0;
+		std::vector<std::string> Strings = { }; // At (Language * (MaxID + 1)) + StringID, without the 0x0 terminator.
+
+		const std::string &Get(const TSGBAStringFetcher::Languages Language, const uint16_t StringID) const {
+			return this->Strings[((uint8_t)Language * (this->MaxID + 1)) + StringID];
+		};
+	};
+
+	TSGBAStringWatcher(const std::string &ROMPath);
+	std::shared_ptr<const Snapshot> GetSnapshot() const { return this->Current.load(); };
+	size_t Refresh();
+
+	#ifdef __linux__
+		void Watch(const std::function<void(const Snapshot &Snap, const size_t Redecoded)> &OnChange, const std::atomic<bool> &Stop);
+	#endif
+private:
+	std::string ROMPath = "";
+	std::atomic<std::shared_ptr<const Snapshot>> Current;
+	std::vector<TSGBAStringFetcher::StringRange> Ranges = { }; // Same order as Snapshot::Strings.
 };
 
 #endif
\ No newline at end of file